@@ -0,0 +1,206 @@
+/*
+ * analyze.c
+ * Author: Michael Bossner
+ *
+ * This file contains functions for analyzing many saved games at once.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "analyze.h"
+#include "game.h"
+#include "tilefile.h"
+#include "tileFit.h"
+#include "saveGame.h"
+#include "autoPlayer.h"
+#include "searchPlayer.h"
+#include "endgame.h"
+#include "generator.h"
+#include "threadPool.h"
+#include "options.h"
+#include "error.h"
+#include "memStats.h"
+
+#define PLAYER_TYPES_LEN 2
+#define PERCENT 100.0
+#define CONTROL_CHARS 0x20
+#define USAGE "fitz --analyze [--threads threads] [--players p1p2] " \
+        "tilefile save..."
+
+typedef struct AnalyzeRun AnalyzeRun;
+
+/*
+ * Everything shared by the jobs of an analysis run
+ */
+struct AnalyzeRun {
+    LoadedTilefile tiles; // Tiles used by every save file
+    char p1Type; // Player 1s type when finishing a game
+    char p2Type; // Player 2s type when finishing a game
+    char** saveNames; // Names of the save files
+    char** results; // The JSON line for each save file
+};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Analyzes one save file and stores its JSON line in the run.
+ *
+ * index: Index of the save file
+ *
+ * run: The AnalyzeRun the save file belongs to
+ */
+static void analyze_save(int index, void* run);
+
+/*
+ * Prints a string as a JSON string including the quotes.
+ *
+ * out: Where the string is printed
+ *
+ * string: The string to be printed
+ */
+static void print_json_string(FILE* out, char* string);
+
+/*
+ * Works out how much of the board is taken by the players.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns the percentage of cells that are taken
+ */
+static double occupancy(GameStateInfo* state);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+int analyze_main(int argc, char** argv) {
+    AnalyzeRun run;
+    int threads = 1;
+    char* players = "11";
+    int arg = 2;
+    // options come before the tilefile
+    while (arg < argc && strncmp(argv[arg], "--", 2) == 0) {
+        if (is_option(argc, argv, arg, "--threads")) {
+            if (!parse_int(argv[arg + 1], &threads) || threads <= 0) {
+                error_usage(USAGE);
+            }
+        } else if (is_option(argc, argv, arg, "--players")) {
+            players = argv[arg + 1];
+        } else {
+            error_usage(USAGE);
+        }
+        arg += 2;
+    }
+    // a tilefile and at least one save
+    if (argc - arg < 2) {
+        error_usage(USAGE);
+    }
+    if (strlen(players) != PLAYER_TYPES_LEN || !is_auto_player(players[P1]) ||
+            !is_auto_player(players[P2])) {
+        error_4();
+    }
+    run.p1Type = players[P1];
+    run.p2Type = players[P2];
+    run.tiles.tilefileName = argv[arg];
+    load_tile_source(&run.tiles);
+    int saves = argc - arg - 1;
+    run.saveNames = &argv[arg + 1];
+    run.results = mem_malloc(MEM_BATCH, sizeof(char*) * saves);
+
+    run_jobs(saves, threads, analyze_save, &run);
+    for (int i = 0; i < saves; i++) {
+        fputs(run.results[i], stdout);
+        // open_memstream allocated the result itself
+        free(run.results[i]);
+    }
+
+    mem_free(MEM_BATCH, run.results);
+    free_loaded_tiles(&run.tiles);
+    return EXIT;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void analyze_save(int index, void* run) {
+    AnalyzeRun* analysis = run;
+    size_t size;
+    FILE* out = open_memstream(&analysis->results[index], &size);
+    fprintf(out, "{\"file\": ");
+    print_json_string(out, analysis->saveNames[index]);
+
+    GameStateInfo state;
+    state.p1Type = analysis->p1Type;
+    state.p2Type = analysis->p2Type;
+    int status = read_save_file(analysis->saveNames[index], &state, 
+            &analysis->tiles);
+    if (status != SAVE_LOADED) {
+        fprintf(out, ", \"status\": \"%s\"}\n", status == SAVE_NO_ACCESS ?
+                "unreadable" : "invalid");
+        fclose(out);
+        return;
+    }
+    state.player = state.turn == P1 ? PLAYER_1 : PLAYER_2;
+    prepare_game(&state, &analysis->tiles, LOAD_GAME);
+    state.quiet = true;
+    bool over = is_game_over(&state);
+    fprintf(out, ", \"status\": \"ok\", \"gameOver\": %s, \"tileIndex\": %d, "
+            "\"legalPlacements\": %d, \"occupancy\": %.2f", 
+            over ? "true" : "false", state.tileIndex, count_placements(&state),
+            occupancy(&state));
+    char mover = state.turn == P1 ? PLAYER_1 : PLAYER_2;
+    char opponent = mover == PLAYER_1 ? PLAYER_2 : PLAYER_1;
+    int endgame = get_search_options()->endgame;
+    if (endgame > 0) {
+        // solved before any turn is played so the memory is of this save
+        int win[INST_MAX];
+        if (count_free_cells(&state) > endgame) {
+            fprintf(out, ", \"exactWinner\": null");
+        } else if (solve_endgame(&state, win, NO_DEADLINE) == SOLVED_WIN) {
+            fprintf(out, ", \"exactWinner\": \"%c\", \"winningMove\": "
+                    "[%d, %d, %d]", mover, win[COLM], win[ROW], win[ROTATE]);
+        } else {
+            fprintf(out, ", \"exactWinner\": \"%c\"", opponent);
+        }
+    }
+    // finish the game with automatic players
+    int turns = 0;
+    while (!play_turn(&state)) {
+        turns++;
+    }
+    // a save that is already over was won by the player who moved last
+    fprintf(out, ", \"autoWinner\": \"%c\", \"turnsToFinish\": %d}\n", 
+            turns == 0 ? opponent : state.player, turns);
+    fclose(out);
+    end_game(&state);
+}
+
+//
+static void print_json_string(FILE* out, char* string) {
+    fputc('"', out);
+    for (; *string != '\0'; string++) {
+        if (*string == '"' || *string == '\\') {
+            fprintf(out, "\\%c", *string);
+        } else if ((unsigned char)*string < CONTROL_CHARS) {
+            fprintf(out, "\\u%04x", (unsigned char)*string);
+        } else {
+            fputc(*string, out);
+        }
+    }
+    fputc('"', out);
+}
+
+//
+static double occupancy(GameStateInfo* state) {
+    long taken = 0;
+    for (int colm = 0; colm < state->height; colm++) {
+        for (int row = 0; row < state->width; row++) {
+            if (state->board[colm][row] == PLAYER_1 || 
+                    state->board[colm][row] == PLAYER_2) {
+                taken++;
+            }
+        }
+    }
+    return PERCENT * taken / ((long)state->height * state->width);
+}
@@ -0,0 +1,35 @@
+/*
+ * analyze.h
+ * Author: Michael Bossner
+ *
+ * Header file for analyze.c
+ */
+
+#ifndef ANALYZE_H
+#define ANALYZE_H
+
+#define ANALYZE "--analyze"
+
+/*
+ * Analyzes many save files at once on a pool of threads. One line of JSON is
+ * printed for each save file in the order they were given.
+ * fitz --analyze [--threads threads] [--players p1p2] tilefile save...
+ * Each line reports whether the game is over, how many placements the 
+ * current tile has, how much of the board is taken and who wins when the
+ * game is finished by automatic players (type 1 for both by default). When
+ * --endgame is given, saves with no more than that many free cells also
+ * report who wins with perfect play and a winning move.
+ *
+ * argc: Number of command line arguments
+ *
+ * argv: The command line arguments
+ *
+ * return: Returns 0 when completed
+ *
+ * error_usage: The arguments are invalid. Program ends.
+ *
+ * error_4: A player type is not an automatic player. Program ends.
+ */
+int analyze_main(int argc, char** argv);
+
+#endif
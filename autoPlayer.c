@@ -10,6 +10,15 @@
 #include "autoPlayer.h"
 #include "game.h"
 #include "tilefile.h"
+#include "tileFit.h"
+#include "searchPlayer.h"
+#include "parallelSearch.h"
+#include "mctsPlayer.h"
+#include "mobilityPlayer.h"
+#include "endgame.h"
+#include "book.h"
+#include "ponder.h"
+#include "stats.h"
 
 ///////////////////////// Private Function Prototypes /////////////////////////
 
@@ -48,8 +57,34 @@ static int auto_type2_p2(GameStateInfo* state);
 
 //////////////////////////////// Functions ////////////////////////////////////
 
+bool is_auto_player(char type) {
+    return type == APT1 || type == APT2 || type == APT3 || type == APT4 ||
+            type == APT5 || type == APT6;
+}
+
 void process_ap(GameStateInfo* state) {
-    if (state->player == PLAYER_1) {
+    PhaseStart start;
+    start_phase(&start);
+    char type = state->player == PLAYER_1 ? state->p1Type : state->p2Type;
+    if (endgame_move(state)) {
+        // a winning move has been found so there is nothing more to choose
+    } else if ((type == APT3 || type == APT4 || type == APT5) &&
+            book_move(state)) {
+        // the opening book has the move
+    } else if (type == APT3 && ponder_move(state)) {
+        // the reply was found while the opponent was choosing their move
+    } else if (type == APT3 && search_move(state)) {
+        // the search finished in time
+    } else if (type == APT4 && parallel_search_move(state)) {
+        // the parallel search finished in time
+    } else if (type == APT3 || type == APT4) {
+        // out of time before any search finished so the first move found
+        auto_type1(state);
+    } else if (type == APT5) {
+        mcts_move(state);
+    } else if (type == APT6) {
+        mobility_move(state);
+    } else if (state->player == PLAYER_1) {
         // Player 1s turn
         if (state->p1Type == APT1) {
             auto_type1(state);
@@ -64,8 +99,11 @@ void process_ap(GameStateInfo* state) {
             auto_type2_p2(state);
         }
     }
-    printf("Player %c => %d %d rotated %d\n", state->player, state->inst[COLM],
-            state->inst[ROW], state->inst[ROTATE]);
+    end_phase(PHASE_AUTO_MOVE, &start);
+    if (!state->quiet) {
+        printf("Player %c => %d %d rotated %d\n", state->player, 
+                state->inst[COLM], state->inst[ROW], state->inst[ROTATE]);
+    }
 }
 
 ////////////////////////////// Private Functions //////////////////////////////
@@ -76,10 +114,12 @@ static int auto_type1(GameStateInfo* state) {
     // rotate through each tile
     for (state->inst[ROTATE] = 0; state->inst[ROTATE] <= ROTATE_270; 
             state->inst[ROTATE] += ROTATE_90) {
-        char** tile = rotate_tile(state->tile, state->inst[ROTATE], CALL);
+        char** tile = get_rotated_tile(state->tiles, state->tileIndex,
+                state->inst[ROTATE]);
 
         do {
-            if (is_move_valid(tile, state, state->inst)) {
+            if (!is_move_ruled_out(state, state->inst) &&
+                    is_move_valid(tile, state, state->inst)) {
                 return VALID;
             } else {
                 // increment through each row
@@ -108,9 +148,10 @@ static int auto_type2_p1(GameStateInfo* state) {
         // rotate through each tile
         for (state->instA2P1[ROTATE] = 0; state->instA2P1[ROTATE] <= 
                 ROTATE_270; state->instA2P1[ROTATE] += ROTATE_90) {
-            char** tile = rotate_tile(state->tile, state->instA2P1[ROTATE],
-                    CALL);
-            if (is_move_valid(tile, state, state->instA2P1)) {
+            char** tile = get_rotated_tile(state->tiles, state->tileIndex,
+                    state->instA2P1[ROTATE]);
+            if (!is_move_ruled_out(state, state->instA2P1) &&
+                    is_move_valid(tile, state, state->instA2P1)) {
                 // update the move instructions into the game state for use
                 state->inst[COLM] = state->instA2P1[COLM];
                 state->inst[ROW] = state->instA2P1[ROW];
@@ -143,9 +184,10 @@ static int auto_type2_p2(GameStateInfo* state) {
         // rotate through each tile
         for (state->instA2P2[ROTATE] = 0; state->instA2P2[ROTATE] <= 
                 ROTATE_270; state->instA2P2[ROTATE] += ROTATE_90) {
-            char** tile = rotate_tile(state->tile, state->instA2P2[ROTATE],
-                    CALL);
-            if (is_move_valid(tile, state, state->instA2P2)) {
+            char** tile = get_rotated_tile(state->tiles, state->tileIndex,
+                    state->instA2P2[ROTATE]);
+            if (!is_move_ruled_out(state, state->instA2P2) &&
+                    is_move_valid(tile, state, state->instA2P2)) {
                 // update the move instructions into the game state for use
                 state->inst[COLM] = state->instA2P2[COLM];
                 state->inst[ROW] = state->instA2P2[ROW];
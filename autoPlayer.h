@@ -13,10 +13,28 @@
 #define APT1 '1'
 #define APT2 '2'
 
+/*
+ * Checks whether a player type is one of the automatic player types.
+ *
+ * type: The player type
+ *
+ * return: Returns true if the type is an automatic player type
+ */
+bool is_auto_player(char type);
+
 /*
  * Processes a computer players turn. The way a computer player chooses it's
  * next move is based of it's player type and for the case of type 2 whether
- * or not it is the first player or the second.
+ * or not it is the first player or the second. Type 3 searches ahead through
+ * the coming tiles, type 4 does the same search on many threads, type 5
+ * plays random games to see which move wins most often and type 6 leaves the
+ * opponent the fewest placements for their next tile. Once --endgame free
+ * cells are left every type plays a winning move if it has one. Types 3 to 5
+ * play the move in the --book opening book when it has the position. With
+ * --ponder type 3 plays the reply it found while a human was choosing their
+ * move when the human made one of the moves it guessed. Types 3 and 4 keep
+ * to --move-time and --game-time and play the type 1 move if the time runs
+ * out before any search has finished.
  * Updates the game state when a valid move is found.
  *
  * state: The current state of the game
@@ -0,0 +1,598 @@
+/*
+ * bench.c
+ * Author: Michael Bossner
+ *
+ * Microbenchmarks for the hot paths of the game. Each benchmark is run at a
+ * range of board sizes and fill levels and the results are printed to stdout
+ * as JSON. Allocations are counted by wrapping malloc with the linker.
+ *
+ * With --scaling full auto player games are played instead at a range of 
+ * board sizes and a CSV row is printed for each game.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "game.h"
+#include "tilefile.h"
+#include "tileFit.h"
+#include "autoPlayer.h"
+#include "saveGame.h"
+#include "parseFile.h"
+#include "generator.h"
+#include "options.h"
+#include "error.h"
+#include "memStats.h"
+
+#define NS_PER_SEC 1000000000LL
+#define NS_PER_MS 1000000LL
+#define DEFAULT_MIN_MS 20
+#define MAX_ITERATIONS 10000000L
+#define BENCH_SEED 2310
+#define BENCH_TILES 20
+#define BENCH_DENSITY 0.3
+#define LOAD_TILES 10000
+#define SIZE_COUNT 5
+#define FILL_COUNT 3
+#define SCALING_MAX_SIZE 100
+#define SCALING_SIZE_COUNT 7
+#define PAIRINGS 4
+#define USAGE "fitzbench [--min-ms ms] [--max-size size]\n" \
+        "       fitzbench --scaling [--max-size size] [--tilefile tilefile] " \
+        "[--turns turns.csv]"
+
+typedef struct BenchContext BenchContext;
+typedef struct Benchmark Benchmark;
+typedef struct GameResult GameResult;
+
+/*
+ * Everything a benchmark needs to run one operation
+ */
+struct BenchContext {
+    GameStateInfo state; // A game with its board filled to the fill level
+    LoadedTilefile tiles; // Tiles used by the game
+    Random random; // Random numbers for picking moves
+    double fill; // Fill level of the board
+    char* tilefileName; // A tilefile written for load_tilefile
+    char* saveName; // A save file written for load_game
+};
+
+/*
+ * A named operation to be timed
+ */
+struct Benchmark {
+    char* name; // Name printed in the results
+    void (*run)(BenchContext* context); // Runs the operation once
+};
+
+/*
+ * What a game played for the scaling benchmark sends back to the parent
+ */
+struct GameResult {
+    int turns; // Number of turns played
+    long long wallNs; // Time taken to play the whole game
+    char winner; // Name of the player that won
+};
+
+/* Allocations made through the wrapped allocator */
+static long allocCount = 0;
+static long allocBytes = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Gets the current time of the monotonic clock.
+ *
+ * return: Returns the time in nanoseconds
+ */
+static long long now_ns(void);
+
+/*
+ * Creates a game with a board of the given size where each cell is taken 
+ * with a chance of fill.
+ *
+ * context: Where the game is created
+ *
+ * height: Height of the board
+ *
+ * width: Width of the board
+ *
+ * fill: Chance of each cell being taken
+ */
+static void setup_context(BenchContext* context, int height, int width, 
+        double fill);
+
+/*
+ * Runs a benchmark until it has taken at least minNs and prints the result.
+ *
+ * out: Where the results are printed
+ *
+ * bench: The benchmark to be run
+ *
+ * context: The game the benchmark is run on
+ *
+ * minNs: The least amount of time to run the benchmark for
+ *
+ * first: Whether this is the first result printed
+ */
+static void run_benchmark(FILE* out, Benchmark* bench, BenchContext* context,
+        long long minNs, bool first);
+
+/*
+ * Writes a temporary file using a generator.
+ *
+ * context: The game the file is written for
+ *
+ * isSave: Whether to write a save file or a tilefile
+ *
+ * return: Returns the name of the file. Must be removed and freed
+ */
+static char* write_temp_file(BenchContext* context, bool isSave);
+
+/*
+ * Reports a temporary file that could not be written, removes it and ends
+ * the program.
+ *
+ * name: Name of the file. Freed
+ *
+ * fd: The file descriptor of the file if it is still open. -1 if not
+ */
+static void temp_file_failed(char* name, int fd);
+
+/*
+ * Plays full games for every pairing of auto player types at each board size
+ * and prints a CSV row for each game. Every game is played in its own 
+ * process so its peak resident set size can be measured.
+ *
+ * out: Where the game rows are printed
+ *
+ * tilefileName: Tiles the games are played with
+ *
+ * maxSize: Largest board size to be played
+ *
+ * turnsName: File to write a CSV row for every turn too. NULL for none
+ */
+static void run_scaling(FILE* out, char* tilefileName, int maxSize, 
+        char* turnsName);
+
+/*
+ * Plays one game timing each turn. Called in the child process.
+ *
+ * tiles: Tiles the game is played with
+ *
+ * p1: Player 1s type
+ *
+ * p2: Player 2s type
+ *
+ * size: Height and width of the board
+ *
+ * turns: Where a row is written for each turn. NULL for none
+ *
+ * return: Returns the result of the game
+ */
+static GameResult play_scaling_game(LoadedTilefile* tiles, char p1, char p2, 
+        int size, FILE* turns);
+
+/* The benchmarks. Each runs its operation once on context */
+static void bench_move_valid(BenchContext* context);
+static void bench_game_over(BenchContext* context);
+static void bench_game_over_cold(BenchContext* context);
+static void bench_rotate_tile(BenchContext* context);
+static void bench_rotated_tile(BenchContext* context);
+static void bench_auto_type1(BenchContext* context);
+static void bench_auto_type2_p1(BenchContext* context);
+static void bench_auto_type2_p2(BenchContext* context);
+static void bench_load_tilefile(BenchContext* context);
+static void bench_split_file(BenchContext* context);
+static void bench_load_game(BenchContext* context);
+static void bench_print_board(BenchContext* context);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+void* __wrap_malloc(size_t size) {
+    allocCount++;
+    allocBytes += size;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    allocCount++;
+    allocBytes += count * size;
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    allocCount++;
+    allocBytes += size;
+    return __real_realloc(pointer, size);
+}
+
+int main(int argc, char** argv) {
+    int minMs = DEFAULT_MIN_MS;
+    int maxSize = 0;
+    bool scaling = false;
+    char* tilefileName = "tilefile";
+    char* turnsName = NULL;
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "--scaling") == 0) {
+            // takes no value
+            scaling = true;
+            i--;
+        } else if (is_option(argc, argv, i, "--tilefile")) {
+            tilefileName = argv[i + 1];
+        } else if (is_option(argc, argv, i, "--turns")) {
+            turnsName = argv[i + 1];
+        } else if (is_option(argc, argv, i, "--min-ms")) {
+            if (!parse_int(argv[i + 1], &minMs) || minMs <= 0) {
+                error_usage(USAGE);
+            }
+        } else if (is_option(argc, argv, i, "--max-size")) {
+            if (!parse_int(argv[i + 1], &maxSize) || maxSize <= 0) {
+                error_usage(USAGE);
+            }
+        } else {
+            error_usage(USAGE);
+        }
+    }
+    int sizes[SIZE_COUNT] = {5, 20, 100, 300, MAX_BOARD_SIZE};
+    double fills[FILL_COUNT] = {0.0, 0.5, 0.9};
+    Benchmark benches[] = {
+        {"is_move_valid", bench_move_valid},
+        {"is_game_over", bench_game_over},
+        {"is_game_over_cold", bench_game_over_cold},
+        {"rotate_tile", bench_rotate_tile},
+        {"get_rotated_tile", bench_rotated_tile},
+        {"auto_type1", bench_auto_type1},
+        {"auto_type2_p1", bench_auto_type2_p1},
+        {"auto_type2_p2", bench_auto_type2_p2},
+        {"load_tilefile", bench_load_tilefile},
+        {"split_file", bench_split_file},
+        {"load_game", bench_load_game},
+        {"print_board", bench_print_board}
+    };
+
+    // the game prints to stdout so results go to a copy of it
+    fflush(stdout);
+    FILE* out = fdopen(dup(STDOUT_FILENO), "w");
+    if (out == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+        return EXIT_FAILURE;
+    }
+    if (scaling) {
+        run_scaling(out, tilefileName, maxSize ? maxSize : SCALING_MAX_SIZE,
+                turnsName);
+        fclose(out);
+        return EXIT;
+    } else if (maxSize == 0) {
+        maxSize = MAX_BOARD_SIZE;
+    }
+    fprintf(out, "{\"benchmarks\": [");
+    bool first = true;
+    for (int s = 0; s < SIZE_COUNT && sizes[s] <= maxSize; s++) {
+        for (int f = 0; f < FILL_COUNT; f++) {
+            BenchContext context;
+            setup_context(&context, sizes[s], sizes[s], fills[f]);
+            for (int b = 0; b < sizeof(benches) / sizeof(Benchmark); b++) {
+                run_benchmark(out, &benches[b], &context, minMs * NS_PER_MS,
+                        first);
+                first = false;
+            }
+            remove(context.tilefileName);
+            remove(context.saveName);
+            free(context.tilefileName);
+            free(context.saveName);
+            end_game(&context.state);
+            free_loaded_tiles(&context.tiles);
+        }
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    return EXIT;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static long long now_ns(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * NS_PER_SEC + time.tv_nsec;
+}
+
+//
+static void setup_context(BenchContext* context, int height, int width, 
+        double fill) {
+    generate_tiles(&context->tiles, BENCH_TILES, BENCH_SEED, BENCH_DENSITY);
+    seed_random(&context->random, BENCH_SEED);
+    context->fill = fill;
+    context->state.height = height;
+    context->state.width = width;
+    context->state.p1Type = APT1;
+    context->state.p2Type = APT1;
+    prepare_game(&context->state, &context->tiles, NEW_GAME);
+    for (int colm = 0; colm < height; colm++) {
+        for (int row = 0; row < width; row++) {
+            if (random_unit(&context->random) < fill) {
+                context->state.board[colm][row] = PLAYER_1;
+            }
+        }
+    }
+    context->tilefileName = write_temp_file(context, false);
+    context->saveName = write_temp_file(context, true);
+}
+
+//
+static void run_benchmark(FILE* out, Benchmark* bench, BenchContext* context,
+        long long minNs, bool first) {
+    long iterations = 0;
+    long startCount = allocCount;
+    long startBytes = allocBytes;
+    long long start = now_ns();
+    long long elapsed;
+    // keep going until enough time has passed to give a stable result
+    do {
+        bench->run(context);
+        iterations++;
+        elapsed = now_ns() - start;
+    } while (elapsed < minNs && iterations < MAX_ITERATIONS);
+    double nsPerOp = (double)elapsed / iterations;
+    fprintf(out, "%s\n  {\"name\": \"%s\", \"height\": %d, \"width\": %d, "
+            "\"fill\": %.2f, \"iterations\": %ld, \"ns_per_op\": %.1f, "
+            "\"ops_per_sec\": %.1f, \"allocs_per_op\": %.2f, "
+            "\"bytes_per_op\": %.1f}", first ? "" : ",", bench->name, 
+            context->state.height, context->state.width, context->fill, 
+            iterations, nsPerOp, NS_PER_SEC / nsPerOp,
+            (double)(allocCount - startCount) / iterations,
+            (double)(allocBytes - startBytes) / iterations);
+    fflush(out);
+}
+
+//
+static char* write_temp_file(BenchContext* context, bool isSave) {
+    char* name = strdup("/tmp/fitzbenchXXXXXX");
+    int fd = mkstemp(name);
+    FILE* file = fd == -1 ? NULL : fdopen(fd, "w");
+    if (file == NULL) {
+        temp_file_failed(name, fd);
+    }
+    if (isSave) {
+        generate_save(file, context->state.height, context->state.width, 
+                context->fill, BENCH_SEED, BENCH_TILES);
+    } else {
+        LoadedTilefile tiles;
+        generate_tiles(&tiles, LOAD_TILES, BENCH_SEED, BENCH_DENSITY);
+        write_tilefile(&tiles, file);
+        free_loaded_tiles(&tiles);
+    }
+    // a full disk is only seen once the buffered writes are flushed
+    bool failed = ferror(file);
+    if (fclose(file) != 0 || failed) {
+        temp_file_failed(name, -1);
+    }
+    return name;
+}
+
+//
+static void temp_file_failed(char* name, int fd) {
+    perror("Can't write temporary file");
+    if (fd != -1) {
+        close(fd);
+    }
+    unlink(name);
+    free(name);
+    exit(EXIT_FAILURE);
+}
+
+//
+static void run_scaling(FILE* out, char* tilefileName, int maxSize, 
+        char* turnsName) {
+    int sizes[SCALING_SIZE_COUNT] = {10, 25, 50, 100, 250, 500, 
+            MAX_BOARD_SIZE};
+    char pairings[PAIRINGS][2] = {{APT1, APT1}, {APT1, APT2}, {APT2, APT1}, 
+            {APT2, APT2}};
+    LoadedTilefile tiles;
+    tiles.tilefileName = tilefileName;
+    load_tile_source(&tiles);
+    FILE* turns = NULL;
+    if (turnsName != NULL) {
+        turns = fopen(turnsName, "w");
+        if (turns == NULL) {
+            error_usage(USAGE);
+        }
+        fprintf(turns, "p1,p2,height,width,turn,fill,turn_ns\n");
+    }
+    fprintf(out, "p1,p2,height,width,turns,wall_ms,ns_per_turn,"
+            "peak_rss_kb,winner\n");
+    fflush(out);
+    for (int s = 0; s < SCALING_SIZE_COUNT && sizes[s] <= maxSize; s++) {
+        for (int p = 0; p < PAIRINGS; p++) {
+            int fds[2];
+            if (pipe(fds) == -1) {
+                return;
+            }
+            if (turns != NULL) {
+                fflush(turns);
+            }
+            pid_t pid = fork();
+            if (pid == 0) {
+                // the game is played in the child
+                close(fds[0]);
+                GameResult result = play_scaling_game(&tiles, 
+                        pairings[p][P1], pairings[p][P2], sizes[s], turns);
+                if (turns != NULL) {
+                    fflush(turns);
+                }
+                if (write(fds[1], &result, sizeof(result)) != 
+                        sizeof(result)) {
+                    _exit(EXIT_FAILURE);
+                }
+                _exit(EXIT);
+            }
+            close(fds[1]);
+            GameResult result;
+            bool received = read(fds[0], &result, sizeof(result)) == 
+                    sizeof(result);
+            close(fds[0]);
+            struct rusage usage;
+            int status;
+            wait4(pid, &status, 0, &usage);
+            if (!received) {
+                continue;
+            }
+            fprintf(out, "%c,%c,%d,%d,%d,%.3f,%.1f,%ld,%c\n", 
+                    pairings[p][P1], pairings[p][P2], sizes[s], sizes[s], 
+                    result.turns, result.wallNs / (double)NS_PER_MS,
+                    result.turns ? result.wallNs / (double)result.turns : 0,
+                    usage.ru_maxrss, result.winner);
+            fflush(out);
+        }
+    }
+    if (turns != NULL) {
+        fclose(turns);
+    }
+    free_loaded_tiles(&tiles);
+}
+
+//
+static GameResult play_scaling_game(LoadedTilefile* tiles, char p1, char p2, 
+        int size, FILE* turns) {
+    GameStateInfo state;
+    GameResult result;
+    state.p1Type = p1;
+    state.p2Type = p2;
+    state.height = size;
+    state.width = size;
+    prepare_game(&state, tiles, NEW_GAME);
+    long filled = 0;
+    result.turns = 0;
+    long long start = now_ns();
+    FOREVER {
+        int placed = get_tile_shape(tiles, state.tileIndex)->cellCount;
+        long long turnStart = now_ns();
+        if (play_turn(&state)) {
+            break;
+        }
+        long long turnNs = now_ns() - turnStart;
+        filled += placed;
+        result.turns++;
+        if (turns != NULL) {
+            fprintf(turns, "%c,%c,%d,%d,%d,%.4f,%lld\n", p1, p2, size, size,
+                    result.turns, (double)filled / ((long)size * size), 
+                    turnNs);
+        }
+    }
+    result.wallNs = now_ns() - start;
+    result.winner = state.player;
+    end_game(&state);
+    return result;
+}
+
+//
+static void bench_move_valid(BenchContext* context) {
+    GameStateInfo* state = &context->state;
+    int inst[INST_MAX];
+    inst[COLM] = next_random(&context->random) % state->height;
+    inst[ROW] = next_random(&context->random) % state->width;
+    inst[ROTATE] = (next_random(&context->random) % ROTATIONS) * ROTATE_90;
+    is_move_valid(get_rotated_tile(state->tiles, state->tileIndex, 
+            inst[ROTATE]), state, inst);
+}
+
+//
+static void bench_game_over(BenchContext* context) {
+    is_game_over(&context->state);
+}
+
+//
+static void bench_game_over_cold(BenchContext* context) {
+    // forget everything learnt by earlier checks
+    free_tile_fit(&context->state);
+    init_tile_fit(&context->state);
+    is_game_over(&context->state);
+}
+
+//
+static void bench_rotate_tile(BenchContext* context) {
+    char** tile = rotate_tile(context->tiles.loadedTiles[0], ROTATE_270, 
+            CALL);
+    for (int i = 0; i < TILE_DIM; i++) {
+        free(tile[i]);
+    }
+    free(tile);
+}
+
+//
+static void bench_rotated_tile(BenchContext* context) {
+    get_rotated_tile(&context->tiles, 0, ROTATE_270);
+}
+
+//
+static void bench_auto_type1(BenchContext* context) {
+    GameStateInfo* state = &context->state;
+    state->player = PLAYER_1;
+    state->p1Type = APT1;
+    state->inst[COLM] = MIN_MOVE;
+    state->inst[ROW] = MIN_MOVE;
+    process_ap(state);
+}
+
+//
+static void bench_auto_type2_p1(BenchContext* context) {
+    GameStateInfo* state = &context->state;
+    state->player = PLAYER_1;
+    state->p1Type = APT2;
+    state->instA2P1[COLM] = MIN_MOVE;
+    state->instA2P1[ROW] = MIN_MOVE;
+    process_ap(state);
+}
+
+//
+static void bench_auto_type2_p2(BenchContext* context) {
+    GameStateInfo* state = &context->state;
+    state->player = PLAYER_2;
+    state->p2Type = APT2;
+    state->instA2P2[COLM] = MAX_MOVE_C;
+    state->instA2P2[ROW] = MAX_MOVE_R;
+    process_ap(state);
+}
+
+//
+static void bench_load_tilefile(BenchContext* context) {
+    LoadedTilefile tiles;
+    tiles.tilefileName = context->tilefileName;
+    load_tilefile(&tiles);
+    free_loaded_tiles(&tiles);
+}
+
+//
+static void bench_split_file(BenchContext* context) {
+    FILE* file = fopen(context->saveName, "r");
+    FileCont splitFile;
+    split_file(file, &splitFile, MEM_PARSER);
+    fclose(file);
+    free_file_cont(&splitFile);
+}
+
+//
+static void bench_load_game(BenchContext* context) {
+    GameStateInfo state;
+    load_game(context->saveName, &state, &context->tiles);
+    free_board(state.board);
+}
+
+//
+static void bench_print_board(BenchContext* context) {
+    print_board(&context->state);
+}
@@ -0,0 +1,366 @@
+/*
+ * book.c
+ * Author: Michael Bossner
+ *
+ * This file contains the opening book. A book is an open addressed hash
+ * table of search results keyed by the canonical key of the position and the
+ * tile to be placed, so a position and its mirror images share an entry. It
+ * is written once by --build-book and mapped straight into memory by --book
+ * so a lookup costs a probe or two. The file is in the byte order of the
+ * machine that built it.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "book.h"
+#include "searchPlayer.h"
+#include "searchBoard.h"
+#include "transTable.h"
+#include "tilefile.h"
+#include "generator.h"
+#include "options.h"
+#include "error.h"
+#include "game.h"
+#include "memStats.h"
+
+#define USAGE "fitz --build-book book [--plies plies] tilefile height width"
+#define BOOK_MAGIC "FITZBOOK"
+#define MAGIC_LEN 8
+#define BOOK_VERSION 2
+#define DEFAULT_PLIES 3
+#define MAX_PLIES 8
+#define MAX_SLOTS (1UL << 26)
+#define BUILD_TABLE_BITS 20
+#define POSITIONAL_ARGS 3
+#define POS_TILEFILE 0
+#define POS_HEIGHT 1
+#define POS_WIDTH 2
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+#define WRITE_FAILED 1
+
+typedef struct BookHeader BookHeader;
+typedef struct BookEntry BookEntry;
+typedef struct BookBuild BookBuild;
+
+/*
+ * The start of a book file
+ */
+struct BookHeader {
+    char magic[MAGIC_LEN]; // BOOK_MAGIC
+    uint32_t version; // BOOK_VERSION
+    uint32_t height; // Height of the board the book is for
+    uint32_t width; // Width of the board the book is for
+    uint32_t plies; // How many moves into the game the book goes
+    uint64_t tilesHash; // tiles_hash of the tiles the book is for
+    uint64_t slotCount; // Number of entries that follow. A power of 2
+};
+
+/*
+ * The move for one position
+ */
+struct BookEntry {
+    uint64_t key; // canonical_key of the position
+    // The move as it is in the canonical position
+    int16_t colm; // Board row of the centre of the tile
+    int16_t row; // Board column of the centre of the tile
+    int16_t rotation; // Rotation of the shape, not of the tile
+    int16_t used; // Whether the entry holds a position
+};
+
+/*
+ * A book being built
+ */
+struct BookBuild {
+    BookHeader header; // The header of the book
+    BookEntry* entries; // The table of positions
+    int plies; // How many moves into the game the book goes
+    int count; // Positions added so far
+};
+
+// The book given by --book. Shared read only by every game
+static BookHeader* book = NULL;
+// Whether a book made for other tiles has been reported
+static int staleReported = 0;
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Searches a position and every position reached by following the beam of
+ * replies, adding the move found for each to the book.
+ *
+ * build: The book being built
+ *
+ * worker: The worker searching. Its board holds the position
+ *
+ * tileIndex: Index of the tile the player to move places
+ *
+ * ply: How many moves into the game the position is
+ */
+static void add_positions(BookBuild* build, SearchWorker* worker,
+        int tileIndex, int ply);
+
+/*
+ * Finds where a position is or belongs in a book table.
+ *
+ * entries: The table
+ *
+ * slotCount: Size of the table. A power of 2
+ *
+ * key: canonical_key of the position
+ *
+ * return: Returns the entry holding the position or the empty entry where it
+ *         would be added. A full table returns some other position
+ */
+static BookEntry* find_entry(BookEntry* entries, uint64_t slotCount,
+        uint64_t key);
+
+/*
+ * Works out a hash of every tile so a book can be matched to its tiles.
+ *
+ * tiles: The tiles
+ *
+ * return: Returns the hash
+ */
+static uint64_t tiles_hash(LoadedTilefile* tiles);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+int build_book_main(int argc, char** argv) {
+    SearchOptions* options = get_search_options();
+    BookBuild build;
+    build.plies = DEFAULT_PLIES;
+    int arg = 2;
+    if (argc < arg + 1) {
+        error_usage(USAGE);
+    }
+    char* path = argv[arg++];
+    if (arg < argc && is_option(argc, argv, arg, "--plies")) {
+        if (!parse_int(argv[arg + 1], &build.plies) || build.plies <= 0 ||
+                build.plies > MAX_PLIES) {
+            error_usage(USAGE);
+        }
+        arg += 2;
+    }
+    if (argc - arg != POSITIONAL_ARGS) {
+        error_usage(USAGE);
+    }
+    char** pos = &argv[arg];
+    GameStateInfo state;
+    if (!parse_int(pos[POS_HEIGHT], &state.height) ||
+            !parse_int(pos[POS_WIDTH], &state.width) || state.height <= 0 ||
+            state.width <= 0 || state.height > MAX_BOARD_SIZE ||
+            state.width > MAX_BOARD_SIZE) {
+        error_5();
+    }
+    LoadedTilefile tiles;
+    tiles.tilefileName = pos[POS_TILEFILE];
+    load_tile_source(&tiles);
+
+    // room for every position the beam can reach with half the table empty
+    uint64_t positions = 0;
+    uint64_t level = tiles.size + 1;
+    for (int ply = 0; ply < build.plies && positions < MAX_SLOTS; ply++) {
+        positions += level;
+        level *= options->beam;
+    }
+    uint64_t slots = 1;
+    while (slots < 2 * positions && slots < MAX_SLOTS) {
+        slots <<= 1;
+    }
+    memcpy(build.header.magic, BOOK_MAGIC, MAGIC_LEN);
+    build.header.version = BOOK_VERSION;
+    build.header.height = state.height;
+    build.header.width = state.width;
+    build.header.plies = build.plies;
+    build.header.tilesHash = tiles_hash(&tiles);
+    build.header.slotCount = slots;
+    build.entries = mem_calloc(MEM_AUTO_PLAYER, slots, sizeof(BookEntry));
+    build.count = 0;
+
+    state.p1Type = APT3;
+    state.p2Type = APT3;
+    prepare_game(&state, &tiles, NEW_GAME);
+    Search* search = get_search(&state, 1);
+    SearchWorker* worker = &search->workers[0];
+    worker->table = create_trans_table(BUILD_TABLE_BITS);
+    worker->repeatable = false;
+    load_search_board(&worker->board, &state);
+    // games can start on any tile
+    for (int tileIndex = 0; tileIndex <= tiles.size; tileIndex++) {
+        add_positions(&build, worker, tileIndex, 0);
+    }
+    free_trans_table(worker->table);
+    end_game(&state);
+    free_loaded_tiles(&tiles);
+
+    FILE* file = fopen(path, "wb");
+    int status = EXIT;
+    if (file == NULL || fwrite(&build.header, sizeof(BookHeader), 1,
+            file) != 1 || fwrite(build.entries, sizeof(BookEntry), slots,
+            file) != slots) {
+        fprintf(stderr, "Can't write opening book %s\n", path);
+        status = WRITE_FAILED;
+    } else {
+        printf("Book: %d positions, %d plies\n", build.count, build.plies);
+    }
+    if (file != NULL && fclose(file) != 0 && status == EXIT) {
+        fprintf(stderr, "Can't write opening book %s\n", path);
+        status = WRITE_FAILED;
+    }
+    mem_free(MEM_AUTO_PLAYER, build.entries);
+    return status;
+}
+
+bool open_book(char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(BookHeader)) {
+        data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    BookHeader* header = data;
+    uint64_t slots = header->slotCount;
+    if (memcmp(header->magic, BOOK_MAGIC, MAGIC_LEN) != 0 ||
+            header->version != BOOK_VERSION || slots == 0 ||
+            (slots & (slots - 1)) != 0 || slots > MAX_SLOTS ||
+            (uint64_t)info.st_size != sizeof(BookHeader) +
+            slots * sizeof(BookEntry)) {
+        munmap(data, info.st_size);
+        return false;
+    }
+    book = header;
+    return true;
+}
+
+bool book_move(GameStateInfo* state) {
+    if (book == NULL || book->height != (uint32_t)state->height ||
+            book->width != (uint32_t)state->width ||
+            state->moveCount >= (int)book->plies) {
+        return false;
+    }
+    if (book->tilesHash != tiles_hash(state->tiles)) {
+        if (!__atomic_exchange_n(&staleReported, 1, __ATOMIC_RELAXED)) {
+            fprintf(stderr, "Opening book is for other tiles and is not "
+                    "used\n");
+        }
+        return false;
+    }
+    Search* search = get_search(state, 1);
+    SearchBoard* board = &search->workers[0].board;
+    load_search_board(board, state);
+    int symmetry;
+    uint64_t key = canonical_key(board, state->tileIndex, &symmetry);
+    BookEntry* entry = find_entry((BookEntry*)(book + 1), book->slotCount,
+            key);
+    if (!entry->used || entry->key != key || entry->rotation < 0 ||
+            entry->rotation >= ROTATIONS) {
+        return false;
+    }
+    SearchSetup* setup = search->setup;
+    Placement move;
+    move.colm = entry->colm;
+    move.row = entry->row;
+    move.rotation = entry->rotation;
+    map_placement(setup, state->tileIndex, &move,
+            setup->symmetries[symmetry].inverse, &move);
+    // a different position with the same key must not give a bad move
+    RotationCells* cells = get_rotation_cells(setup, state->tileIndex,
+            move.rotation);
+    if (move.colm < -cells->minY ||
+            move.colm >= setup->height - cells->maxY ||
+            move.row < -cells->minX ||
+            move.row >= setup->width - cells->maxX ||
+            !fits_at(board, cells,
+            get_tile_shape(setup->tiles, state->tileIndex)->cellCount,
+            move.colm * setup->width + move.row)) {
+        return false;
+    }
+    placement_to_inst(setup, state->tileIndex, &move, state->inst);
+    return true;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void add_positions(BookBuild* build, SearchWorker* worker,
+        int tileIndex, int ply) {
+    // keeping half the table empty keeps probes short
+    if (2 * (uint64_t)build->count >= build->header.slotCount) {
+        return;
+    }
+    int symmetry;
+    uint64_t key = canonical_key(&worker->board, tileIndex, &symmetry);
+    BookEntry* entry = find_entry(build->entries, build->header.slotCount,
+            key);
+    if (entry->used) {
+        // reached before by other moves
+        return;
+    }
+    Placement replies[MAX_BEAM];
+    int count = collect_moves(worker, tileIndex, NO_MOVE, replies);
+    if (count == 0) {
+        return;
+    }
+    search_position(worker, tileIndex, get_search_options()->depth,
+            -INFINITE_SCORE, INFINITE_SCORE, 0);
+    Placement move;
+    map_placement(worker->board.setup, tileIndex, &worker->best, symmetry,
+            &move);
+    entry->key = key;
+    entry->colm = move.colm;
+    entry->row = move.row;
+    entry->rotation = move.rotation;
+    entry->used = 1;
+    build->count++;
+    if (ply + 1 >= build->plies) {
+        return;
+    }
+    LoadedTilefile* tiles = worker->board.setup->tiles;
+    for (int i = 0; i < count; i++) {
+        set_placement(&worker->board, tileIndex, &replies[i], 1);
+        add_positions(build, worker, next_tile(tiles, tileIndex), ply + 1);
+        set_placement(&worker->board, tileIndex, &replies[i], 0);
+    }
+}
+
+//
+static BookEntry* find_entry(BookEntry* entries, uint64_t slotCount,
+        uint64_t key) {
+    uint64_t slot = key & (slotCount - 1);
+    // a full table read from a file must still end
+    for (uint64_t i = 1; i < slotCount && entries[slot].used &&
+            entries[slot].key != key; i++) {
+        slot = (slot + 1) & (slotCount - 1);
+    }
+    return &entries[slot];
+}
+
+//
+static uint64_t tiles_hash(LoadedTilefile* tiles) {
+    uint64_t hash = FNV_OFFSET;
+    for (int i = 0; i <= tiles->size; i++) {
+        for (int y = 0; y < TILE_DIM; y++) {
+            for (int x = 0; x < TILE_DIM; x++) {
+                hash = (hash ^ (unsigned char)tiles->loadedTiles[i][y][x]) *
+                        FNV_PRIME;
+            }
+        }
+    }
+    return hash;
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+ * book.h
+ * Author: Michael Bossner
+ *
+ * Header file for book.c
+ */
+
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <stdbool.h>
+
+#include "game.h"
+
+#define BUILD_BOOK "--build-book"
+
+/*
+ * Builds an opening book from the moves of the search player. Starting from
+ * an empty board on every tile, each position is searched with the search
+ * options and the beam of replies is followed for the given number of
+ * plies.
+ * fitz --build-book book [--plies plies] tilefile height width
+ *
+ * argc: Number of command line arguments
+ *
+ * argv: The command line arguments
+ *
+ * return: Returns 0 when completed or 1 if the book can't be written
+ *
+ * error_usage: The arguments are invalid. Program ends.
+ *
+ * error_5: The dimensions are invalid. Program ends.
+ */
+int build_book_main(int argc, char** argv);
+
+/*
+ * Maps an opening book into memory for the rest of the program.
+ *
+ * path: Name of the book file
+ *
+ * return: Returns false if the file can't be read or is not an opening book
+ */
+bool open_book(char* path);
+
+/*
+ * Looks up the current position in the opening book. A book made for other
+ * tiles is reported once and never used.
+ * Updates state->inst with the move found.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns true if the book has a move for the position
+ */
+bool book_move(GameStateInfo* state);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,260 @@
+/*
+ * endgame.c
+ * Author: Michael Bossner
+ *
+ * This file contains the solver that plays out every move to the end of the
+ * game once few cells are left. Whether the player to move wins only
+ * depends on the free cells and the tile to be placed, so each position is
+ * remembered in a table by the Zobrist key of the two, taken the same way
+ * for every turn or reflection of the board that the tiles allow.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "endgame.h"
+#include "searchPlayer.h"
+#include "searchBoard.h"
+#include "transTable.h"
+#include "tilefile.h"
+#include "game.h"
+#include "memStats.h"
+
+#define SOLVED_TABLE_BITS 20
+#define CLOCK_CHECK 256
+#define MILLISECONDS 1e3
+#define NANOSECONDS 1e9
+
+typedef struct Solver Solver;
+
+/*
+ * Everything one solve uses
+ */
+struct Solver {
+    SearchBoard board; // The board as the solver plays through the game
+    TransTable* table; // Positions already solved
+    int* freeCells; // Cells that were free at the start
+    int freeCount; // Number of free cells at the start
+    Placement* moves; // The moves of each ply
+    int maxMoves; // Most moves a ply can have
+    unsigned long nodes; // Positions solved
+    unsigned long hits; // Positions found in the table
+    int64_t deadline; // search_clock at which to give up. NO_DEADLINE if none
+    bool stopped; // Whether the deadline has passed
+};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Finds whether the player to move wins a position.
+ *
+ * solver: The solver. Its board holds the position
+ *
+ * tileIndex: Index of the tile the player to move places
+ *
+ * ply: How many moves from the start of the solve the position is
+ *
+ * win: Where a winning move is returned. May be NULL
+ *
+ * return: Returns SOLVED_WIN if the player to move wins, SOLVED_LOSS if they
+ *         lose or SOLVED_UNKNOWN if the deadline passed first
+ */
+static int solve(Solver* solver, int tileIndex, int ply, Placement* win);
+
+/*
+ * Lists the placements of a tile. Every cell of a placement is free so each
+ * one is found by putting the first cell of its shape on a free cell.
+ *
+ * solver: The solver. Its board holds the position
+ *
+ * tileIndex: Index of the tile
+ *
+ * moves: Where the placements are returned. May be NULL to only count them
+ *
+ * return: Returns the number of placements
+ */
+static int list_free_moves(Solver* solver, int tileIndex, Placement* moves);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+int count_free_cells(GameStateInfo* state) {
+    int count = 0;
+    for (int colm = 0; colm < state->height; colm++) {
+        for (int row = 0; row < state->width; row++) {
+            if (state->board[colm][row] != PLAYER_1 &&
+                    state->board[colm][row] != PLAYER_2) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+int solve_endgame(GameStateInfo* state, int* inst, int64_t deadline) {
+    Search* search = get_search(state, 1);
+    if (search->solved == NULL) {
+        search->solved = create_trans_table(SOLVED_TABLE_BITS);
+    }
+    Solver solver;
+    init_search_board(&solver.board, search->setup);
+    load_search_board(&solver.board, state);
+    solver.table = search->solved;
+    solver.freeCount = count_free_cells(state);
+    solver.freeCells = mem_malloc(MEM_AUTO_PLAYER,
+            sizeof(int) * (solver.freeCount + 1));
+    int count = 0;
+    for (int cell = 0; cell < state->height * state->width; cell++) {
+        if (!solver.board.cells[cell]) {
+            solver.freeCells[count++] = cell;
+        }
+    }
+    // every move fills a cell so no game is longer than the free cells
+    solver.maxMoves = ROTATIONS * solver.freeCount + 1;
+    solver.moves = mem_malloc(MEM_AUTO_PLAYER,
+            sizeof(Placement) * solver.maxMoves * (solver.freeCount + 1));
+    solver.nodes = 0;
+    solver.hits = 0;
+    solver.deadline = deadline;
+    solver.stopped = false;
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    Placement win;
+    int result = solve(&solver, state->tileIndex, 0, &win);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (result == SOLVED_WIN && inst != NULL) {
+        placement_to_inst(search->setup, state->tileIndex, &win, inst);
+    }
+    if (get_search_options()->stats) {
+        fprintf(stderr, "Player %c endgame: %d free cells, %s, %lu positions, "
+                "%lu remembered, %.3f ms\n", state->player, solver.freeCount,
+                result == SOLVED_WIN ? "win" : result == SOLVED_LOSS ?
+                "loss" : "unknown", solver.nodes, solver.hits,
+                ((end.tv_sec - start.tv_sec) +
+                (end.tv_nsec - start.tv_nsec) / NANOSECONDS) * MILLISECONDS);
+    }
+    mem_free(MEM_AUTO_PLAYER, solver.moves);
+    mem_free(MEM_AUTO_PLAYER, solver.freeCells);
+    free_search_board(&solver.board);
+    return result;
+}
+
+bool endgame_move(GameStateInfo* state) {
+    int cells = get_search_options()->endgame;
+    if (cells == 0 || count_free_cells(state) > cells) {
+        return false;
+    }
+    int64_t start = search_clock();
+    int result = solve_endgame(state, state->inst,
+            move_deadline(state, start));
+    // a search after an unsolved endgame has what is left of the move
+    get_search(state, 1)->spent[state->turn] += search_clock() - start;
+    return result == SOLVED_WIN;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int solve(Solver* solver, int tileIndex, int ply, Placement* win) {
+    solver->nodes++;
+    if (solver->deadline != NO_DEADLINE && solver->nodes % CLOCK_CHECK == 0 &&
+            search_clock() >= solver->deadline) {
+        solver->stopped = true;
+    }
+    if (solver->stopped) {
+        return SOLVED_UNKNOWN;
+    }
+    // no move is kept so a position and its mirror images are one entry
+    int symmetry;
+    uint64_t key = canonical_key(&solver->board, tileIndex, &symmetry);
+    TableEntry entry;
+    // the root needs a winning move which the table does not keep
+    if (win == NULL && probe_table(solver->table, key, &entry)) {
+        solver->hits++;
+        return entry.score;
+    }
+    LoadedTilefile* tiles = solver->board.setup->tiles;
+    int next = next_tile(tiles, tileIndex);
+    Placement* moves = &solver->moves[ply * solver->maxMoves];
+    int count = list_free_moves(solver, tileIndex, moves);
+    int found = NO_MOVE;
+    // moves leaving the opponent the fewest replies are tried first
+    for (int i = 0; i < count && found == NO_MOVE; i++) {
+        set_placement(&solver->board, tileIndex, &moves[i], 1);
+        moves[i].score = list_free_moves(solver, next, NULL);
+        set_placement(&solver->board, tileIndex, &moves[i], 0);
+        if (moves[i].score == 0) {
+            found = i;
+        }
+    }
+    if (found == NO_MOVE) {
+        for (int i = 1; i < count; i++) {
+            Placement move = moves[i];
+            int j = i;
+            for (; j > 0 && moves[j - 1].score > move.score; j--) {
+                moves[j] = moves[j - 1];
+            }
+            moves[j] = move;
+        }
+    }
+    for (int i = 0; i < count && found == NO_MOVE && !solver->stopped; i++) {
+        set_placement(&solver->board, tileIndex, &moves[i], 1);
+        if (solve(solver, next, ply + 1, NULL) == SOLVED_LOSS) {
+            found = i;
+        }
+        set_placement(&solver->board, tileIndex, &moves[i], 0);
+    }
+    if (found == NO_MOVE && solver->stopped) {
+        // the moves not yet solved may still win
+        return SOLVED_UNKNOWN;
+    }
+    entry.score = found == NO_MOVE ? SOLVED_LOSS : SOLVED_WIN;
+    entry.move = NO_MOVE;
+    entry.depth = 0;
+    entry.bound = BOUND_EXACT;
+    store_table(solver->table, key, &entry);
+    if (found != NO_MOVE && win != NULL) {
+        *win = moves[found];
+    }
+    return entry.score;
+}
+
+//
+static int list_free_moves(Solver* solver, int tileIndex, Placement* moves) {
+    SearchSetup* setup = solver->board.setup;
+    TileShape* shape = get_tile_shape(setup->tiles, tileIndex);
+    int count = 0;
+    Placement move;
+    move.score = 0;
+    for (move.rotation = 0; move.rotation < shape->distinct;
+            move.rotation++) {
+        RotationCells* cells = get_rotation_cells(setup, tileIndex,
+                move.rotation);
+        for (int i = 0; i < solver->freeCount; i++) {
+            int cell = solver->freeCells[i];
+            if (solver->board.cells[cell]) {
+                continue;
+            }
+            move.colm = cell / setup->width - shape->cellY[move.rotation][0];
+            move.row = cell % setup->width - shape->cellX[move.rotation][0];
+            if (move.colm < -cells->minY ||
+                    move.colm >= setup->height - cells->maxY ||
+                    move.row < -cells->minX ||
+                    move.row >= setup->width - cells->maxX ||
+                    !fits_at(&solver->board, cells, shape->cellCount,
+                    move.colm * setup->width + move.row)) {
+                continue;
+            }
+            if (moves != NULL) {
+                moves[count] = move;
+            }
+            count++;
+        }
+    }
+    return count;
+}
\ No newline at end of file
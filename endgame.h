@@ -0,0 +1,61 @@
+/*
+ * endgame.h
+ * Author: Michael Bossner
+ *
+ * Header file for endgame.c
+ */
+
+#ifndef ENDGAME_H
+#define ENDGAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game.h"
+
+#define SOLVED_WIN 1
+#define SOLVED_LOSS -1
+#define SOLVED_UNKNOWN 0
+#define MAX_ENDGAME 256
+
+/*
+ * Counts the cells of the board no player has taken.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns the number of free cells
+ */
+int count_free_cells(GameStateInfo* state);
+
+/*
+ * Searches every move to the end of the game to find whether the player to
+ * move can force a win. Positions already solved are remembered for the
+ * rest of the game. Only small numbers of free cells can be solved quickly.
+ *
+ * state: The current state of the game. No more than MAX_ENDGAME cells are
+ *         free
+ *
+ * inst: Where a winning move is returned if there is one. May be NULL
+ *
+ * deadline: search_clock at which the search gives up. NO_DEADLINE if none
+ *
+ * return: Returns SOLVED_WIN if the player to move wins whatever the
+ *         opponent does, SOLVED_LOSS if they lose and SOLVED_UNKNOWN if the
+ *         deadline passed first
+ */
+int solve_endgame(GameStateInfo* state, int* inst, int64_t deadline);
+
+/*
+ * Plays a winning move for the current player once there are no more than
+ * --endgame free cells. The search stops at the deadline of the move. When
+ * the position is lost, still too big or not solved in time the player's
+ * own way of choosing a move is left to make it.
+ * Updates state->inst with the move chosen.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns true if a winning move was chosen
+ */
+bool endgame_move(GameStateInfo* state);
+
+#endif
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #include "error.h"
 #include "tilefile.h"
+#include "flightRecorder.h"
 
 #define ERR_1 1
 #define ERR_2 2
@@ -19,6 +20,12 @@
 #define ERR_6 6
 #define ERR_7 7
 #define ERR_10 10
+#define ERR_11 11
+
+void error_usage(char* usage) {
+    fprintf(stderr, "Usage: %s\n", usage);
+    exit(ERR_1);
+}
 
 void error_1(void) {
     fprintf(stderr, "Usage: fitz tilefile [p1type p2type "
@@ -33,6 +40,7 @@ void error_2(void) {
 
 void error_3(void) {
     fprintf(stderr, "Invalid tile file contents\n");
+    dump_flight_recorder("Invalid tile file contents");
     exit(ERR_3);
 }
 
@@ -53,14 +61,22 @@ void error_6(void) {
 
 void error_7(void) {
     fprintf(stderr, "Invalid save file contents\n");
+    dump_flight_recorder("Invalid save file contents");
     exit(ERR_7);
 }
 
 void error_10(void) {
     fprintf(stderr, "End of input\n");
+    dump_flight_recorder("End of input");
     exit(ERR_10);
 }
 
+void error_11(void) {
+    fprintf(stderr, "Allocation budget exceeded\n");
+    dump_flight_recorder("Allocation budget exceeded");
+    exit(ERR_11);
+}
+
 void err_save_fail(void) {
     fprintf(stderr, "Unable to save game");
 }
\ No newline at end of file
@@ -8,6 +8,15 @@
 #ifndef ERROR_H
 #define ERROR_H
 
+/*
+ * Used when the command line arguments for one of the extra modes of the
+ * program are invalid. The function will print the usage of the mode to
+ * stderr and exit the program giving the exit status of 1.
+ *
+ * usage: How the mode is used
+ */
+void error_usage(char* usage);
+
 /*
  * Used when an invalid amount of command line arguments are given on the start
  * of the program. The function will print an error message to stderr and exit 
@@ -63,6 +72,13 @@ void error_7(void);
  */ 
 void error_10(void);
 
+/*
+ * Used when a turn makes more allocations than the budget given by
+ * --alloc-budget. The function will print an error message to stderr and
+ * exit the program giving the exit status of 11.
+ */
+void error_11(void);
+
 /*
  * Used when an attempt to save the game fails.
  * An error will be printed to stderr.
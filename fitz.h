@@ -0,0 +1,241 @@
+/*
+ * fitz.h
+ * Author: Michael Bossner
+ *
+ * Public interface of libfitz. Lets other programs run any number of games
+ * in process. No function in this interface ends the process or prints
+ * anything; every problem is reported through the returned status code.
+ */
+
+#ifndef FITZ_H
+#define FITZ_H
+
+#include <stddef.h>
+
+#define FITZ_OK 0
+#define FITZ_ERR_ACCESS 1
+#define FITZ_ERR_TILES 2
+#define FITZ_ERR_PLAYER 3
+#define FITZ_ERR_DIMENSIONS 4
+#define FITZ_ERR_SAVE 5
+#define FITZ_ERR_MOVE 6
+#define FITZ_ERR_GAME_OVER 7
+#define FITZ_ERR_NOT_AUTO 8
+#define FITZ_ERR_BUFFER 9
+#define FITZ_ERR_NO_UNDO 10
+
+#define FITZ_HUMAN 'h'
+
+typedef struct FitzTiles FitzTiles;
+typedef struct FitzGame FitzGame;
+typedef struct FitzMove FitzMove;
+
+/*
+ * A move in the same form a human player enters it
+ */
+struct FitzMove {
+    int colm; // Row of the board the centre of the tile is placed on
+    int row; // Column of the board the centre of the tile is placed on
+    int rotate; // Rotation of the tile. 0, 90, 180 or 270
+};
+
+/*
+ * Loads tiles from a tilefile. The tiles can be shared by any number of
+ * games, including games on other threads, but must outlive them.
+ *
+ * path: Name of the tilefile
+ *
+ * tiles: Where the loaded tiles are returned
+ *
+ * return: FITZ_OK, FITZ_ERR_ACCESS or FITZ_ERR_TILES
+ */
+int fitz_tiles_load(const char* path, FitzTiles** tiles);
+
+/*
+ * Loads tiles from a buffer holding the contents of a tilefile.
+ *
+ * data: Contents of the tilefile
+ *
+ * size: Number of bytes in data
+ *
+ * tiles: Where the loaded tiles are returned
+ *
+ * return: FITZ_OK or FITZ_ERR_TILES
+ */
+int fitz_tiles_from_buffer(const char* data, size_t size, FitzTiles** tiles);
+
+/*
+ * Frees tiles loaded by fitz_tiles_load or fitz_tiles_from_buffer.
+ *
+ * tiles: The tiles to be freed
+ */
+void fitz_tiles_free(FitzTiles* tiles);
+
+/*
+ * Creates a new game with an empty board.
+ *
+ * tiles: Tiles the game is played with
+ *
+ * height: Height of the board. 1 to 999
+ *
+ * width: Width of the board. 1 to 999
+ *
+ * p1Type: Player 1s type. FITZ_HUMAN for moves given by fitz_game_apply or
+ *         an automatic player type for moves made by fitz_game_step
+ *
+ * p2Type: Player 2s type
+ *
+ * game: Where the new game is returned
+ *
+ * return: FITZ_OK, FITZ_ERR_PLAYER or FITZ_ERR_DIMENSIONS
+ */
+int fitz_game_new(FitzTiles* tiles, int height, int width, char p1Type, 
+        char p2Type, FitzGame** game);
+
+/*
+ * Creates a game from a buffer holding the contents of a save file.
+ *
+ * tiles: Tiles the game is played with
+ *
+ * data: Contents of the save file
+ *
+ * size: Number of bytes in data
+ *
+ * p1Type: Player 1s type
+ *
+ * p2Type: Player 2s type
+ *
+ * game: Where the loaded game is returned
+ *
+ * return: FITZ_OK, FITZ_ERR_PLAYER or FITZ_ERR_SAVE
+ */
+int fitz_game_load(FitzTiles* tiles, const char* data, size_t size, 
+        char p1Type, char p2Type, FitzGame** game);
+
+/*
+ * Writes a game to a buffer in the save file format.
+ *
+ * game: The game to be saved
+ *
+ * buffer: Where the save is written. May be NULL when size is 0
+ *
+ * size: Number of bytes available in buffer
+ *
+ * written: Where the size of the save is returned. When the buffer is too
+ *         small this is the size needed
+ *
+ * return: FITZ_OK or FITZ_ERR_BUFFER
+ */
+int fitz_game_save(FitzGame* game, char* buffer, size_t size, 
+        size_t* written);
+
+/*
+ * Checks whether the current tile can no longer be placed.
+ *
+ * game: The game to be checked
+ *
+ * return: Returns 1 if the game is over or 0 if it is not
+ */
+int fitz_game_is_over(FitzGame* game);
+
+/*
+ * Gets the player whose turn it is. Once the game is over this is the
+ * player who won.
+ *
+ * game: The game
+ *
+ * return: Returns '*' for player 1 or '#' for player 2
+ */
+char fitz_game_player(FitzGame* game);
+
+/*
+ * Gets the index of the tile to be placed next.
+ *
+ * game: The game
+ *
+ * return: Returns the index of the current tile
+ */
+int fitz_game_tile_index(FitzGame* game);
+
+/*
+ * Gets a cell of the board.
+ *
+ * game: The game
+ *
+ * colm: Row of the cell
+ *
+ * row: Column of the cell
+ *
+ * return: Returns '.' for an empty cell, '*' or '#' for a taken cell or 0
+ *         when the cell is off the board
+ */
+char fitz_game_cell(FitzGame* game, int colm, int row);
+
+/*
+ * Lists the legal moves for the current tile. Rotations that repeat the 
+ * cells of an earlier rotation are left out.
+ *
+ * game: The game
+ *
+ * moves: Where the moves are stored. May be NULL when max is 0
+ *
+ * max: Most moves that can be stored
+ *
+ * count: Where the number of legal moves is returned. Can be more than max
+ *
+ * return: FITZ_OK or FITZ_ERR_BUFFER when there are more than max moves
+ */
+int fitz_game_legal_moves(FitzGame* game, FitzMove* moves, int max, 
+        int* count);
+
+/*
+ * Makes a move for the current player.
+ *
+ * game: The game
+ *
+ * move: The move to be made
+ *
+ * return: FITZ_OK, FITZ_ERR_GAME_OVER or FITZ_ERR_MOVE if the move is not 
+ *         legal
+ */
+int fitz_game_apply(FitzGame* game, FitzMove move);
+
+/*
+ * Runs one turn for the current player when it is an automatic player.
+ *
+ * game: The game
+ *
+ * played: Where the move made is returned. May be NULL
+ *
+ * return: FITZ_OK, FITZ_ERR_GAME_OVER or FITZ_ERR_NOT_AUTO when the current
+ *         player is not an automatic player
+ */
+int fitz_game_step(FitzGame* game, FitzMove* played);
+
+/*
+ * Takes back the last move made by fitz_game_apply or fitz_game_step. Every
+ * move made since the game was created or loaded can be taken back in turn.
+ *
+ * game: The game
+ *
+ * return: FITZ_OK or FITZ_ERR_NO_UNDO when there is no move to take back
+ */
+int fitz_game_undo(FitzGame* game);
+
+/*
+ * Frees a game.
+ *
+ * game: The game to be freed
+ */
+void fitz_game_free(FitzGame* game);
+
+/*
+ * Describes a status code.
+ *
+ * status: The status code
+ *
+ * return: Returns a description of the status code
+ */
+const char* fitz_strerror(int status);
+
+#endif
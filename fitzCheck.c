@@ -0,0 +1,139 @@
+/*
+ * fitzCheck.c
+ * Author: Michael Bossner
+ *
+ * This file contains checks of libfitz run by make check. Each check prints
+ * what went wrong and the program exits with 1 when any of them fail.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fitz.h"
+
+#define TILEFILE "tilefile"
+#define SIZE_COUNT 4
+#define PAIRINGS 4
+#define EMPTY_SAVE "0 0 0 3\n"
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Plays a game to its end, saves it and loads the save. The loaded game must
+ * be over with the same winner as the game that was played.
+ *
+ * tiles: Tiles the game is played with
+ *
+ * size: Height and width of the board
+ *
+ * p1Type: Player 1s type
+ *
+ * p2Type: Player 2s type
+ *
+ * return: Returns 1 if the check passed or 0 if it failed
+ */
+static int check_save_round_trip(FitzTiles* tiles, int size, char p1Type,
+        char p2Type);
+
+/*
+ * Loads a save of a board with no rows. Nothing can be placed so the game
+ * must be over, won by the player who did not have to move.
+ *
+ * tiles: Tiles the game is played with
+ *
+ * return: Returns 1 if the check passed or 0 if it failed
+ */
+static int check_empty_save(FitzTiles* tiles);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+int main(int argc, char** argv) {
+    FitzTiles* tiles;
+    int status = fitz_tiles_load(TILEFILE, &tiles);
+    if (status != FITZ_OK) {
+        fprintf(stderr, "Can't load %s: %s\n", TILEFILE,
+                fitz_strerror(status));
+        return EXIT_FAILURE;
+    }
+    int sizes[SIZE_COUNT] = {1, 5, 9, 13};
+    char pairings[PAIRINGS][2] = {{'1', '1'}, {'1', '2'}, {'2', '1'},
+            {'2', '2'}};
+    int failed = 0;
+    for (int i = 0; i < SIZE_COUNT; i++) {
+        for (int j = 0; j < PAIRINGS; j++) {
+            failed += !check_save_round_trip(tiles, sizes[i], pairings[j][0],
+                    pairings[j][1]);
+        }
+    }
+    failed += !check_empty_save(tiles);
+    fitz_tiles_free(tiles);
+    if (failed) {
+        fprintf(stderr, "%d libfitz checks failed\n", failed);
+        return EXIT_FAILURE;
+    }
+    printf("libfitz checks passed\n");
+    return EXIT_SUCCESS;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int check_save_round_trip(FitzTiles* tiles, int size, char p1Type,
+        char p2Type) {
+    FitzGame* game;
+    if (fitz_game_new(tiles, size, size, p1Type, p2Type, &game) != FITZ_OK) {
+        fprintf(stderr, "%dx%d %c%c: can't create the game\n", size, size,
+                p1Type, p2Type);
+        return 0;
+    }
+    while (fitz_game_step(game, NULL) == FITZ_OK) {
+        // played until the game is over
+    }
+    char winner = fitz_game_player(game);
+    size_t written;
+    fitz_game_save(game, NULL, 0, &written);
+    char* save = malloc(written);
+    fitz_game_save(game, save, written, &written);
+    fitz_game_free(game);
+    int passed = 0;
+    if (fitz_game_load(tiles, save, written, p1Type, p2Type, &game) !=
+            FITZ_OK) {
+        fprintf(stderr, "%dx%d %c%c: can't load the save\n", size, size,
+                p1Type, p2Type);
+    } else {
+        if (!fitz_game_is_over(game)) {
+            fprintf(stderr, "%dx%d %c%c: loaded game is not over\n", size,
+                    size, p1Type, p2Type);
+        } else if (fitz_game_player(game) != winner) {
+            fprintf(stderr, "%dx%d %c%c: winner %c became %c after loading\n",
+                    size, size, p1Type, p2Type, winner,
+                    fitz_game_player(game));
+        } else {
+            passed = 1;
+        }
+        fitz_game_free(game);
+    }
+    free(save);
+    return passed;
+}
+
+//
+static int check_empty_save(FitzTiles* tiles) {
+    FitzGame* game;
+    if (fitz_game_load(tiles, EMPTY_SAVE, strlen(EMPTY_SAVE), '1', '1',
+            &game) != FITZ_OK) {
+        fprintf(stderr, "empty board: can't load the save\n");
+        return 0;
+    }
+    int passed = 0;
+    if (!fitz_game_is_over(game)) {
+        fprintf(stderr, "empty board: loaded game is not over\n");
+    } else if (fitz_game_player(game) != '#') {
+        fprintf(stderr, "empty board: winner %c instead of #\n",
+                fitz_game_player(game));
+    } else {
+        passed = 1;
+    }
+    fitz_game_free(game);
+    return passed;
+}
\ No newline at end of file
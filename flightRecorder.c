@@ -0,0 +1,235 @@
+/*
+ * flightRecorder.c
+ * Author: Michael Bossner
+ *
+ * This file contains the flight recorder turned on by --flight. The last
+ * FLIGHT_EVENTS events are kept in a ring that any thread adds to with one
+ * atomic add, so recording costs a few stores. Each slot holds the number
+ * of the event in it once it is written, which lets a dump skip slots that
+ * are half written or were written over. The dump only uses calls that are
+ * safe in a signal handler.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "flightRecorder.h"
+#include "game.h"
+
+#define FLIGHT_EVENTS 4096
+#define FLIGHT_MASK (FLIGHT_EVENTS - 1)
+#define FLIGHT_TEXT 16
+#define MAX_PATH 4096
+#define LINE_SIZE 256
+#define NUMBER_SIZE 24
+#define DECIMAL 10
+#define FILE_MODE 0644
+#define NO_PLAYER '-'
+
+typedef struct FlightEvent FlightEvent;
+
+/*
+ * One event of the flight recorder
+ */
+struct FlightEvent {
+    uint64_t number; // Number of the event plus 1. 0 while it is written
+    uint32_t game; // Which game it happened in. 0 for none
+    char type; // One of the FLIGHT_ defines
+    char player; // Player to move or NO_PLAYER
+    int16_t tileIndex; // Tile the player to move places. -1 for none
+    int32_t values[3]; // What the values mean depends on the type
+    char text[FLIGHT_TEXT]; // The start of the text. Not null terminated
+};
+
+// Whether events are recorded
+static bool enabled = false;
+// Where the events are written
+static char flightPath[MAX_PATH];
+// The events
+static FlightEvent ring[FLIGHT_EVENTS];
+// Number of events recorded so far
+static uint64_t nextEvent = 0;
+// Whether the events have been written
+static int dumped = 0;
+// Name of each type of event
+static const char* typeNames[FLIGHT_TYPES] = {"tiles", "move", "input",
+        "save", "load"};
+// Signals that end the program which the events are written for
+static const int crashSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Writes the events and ends the program by the signal. Registered with
+ * sigaction.
+ *
+ * signalNumber: The signal
+ */
+static void crash_handler(int signalNumber);
+
+/*
+ * Adds text to a line.
+ *
+ * line: The line
+ *
+ * length: Length of the line. Updated with the new length
+ *
+ * text: The text
+ *
+ * count: Most characters of the text to add
+ */
+static void add_text(char* line, int* length, const char* text, int count);
+
+/*
+ * Adds a number and a space to a line.
+ *
+ * line: The line
+ *
+ * length: Length of the line. Updated with the new length
+ *
+ * number: The number
+ */
+static void add_number(char* line, int* length, long number);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+void enable_flight_recorder(char* path) {
+    strncpy(flightPath, path, MAX_PATH - 1);
+    if (enabled) {
+        return;
+    }
+    enabled = true;
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = crash_handler;
+    sigemptyset(&action.sa_mask);
+    // the signal is raised again with its usual action once written
+    action.sa_flags = SA_RESETHAND;
+    for (size_t i = 0; i < sizeof(crashSignals) / sizeof(int); i++) {
+        sigaction(crashSignals[i], &action, NULL);
+    }
+}
+
+void record_flight(int type, GameStateInfo* state, int a, int b, int c,
+        const char* text) {
+    if (!enabled) {
+        return;
+    }
+    uint64_t number = __atomic_fetch_add(&nextEvent, 1, __ATOMIC_RELAXED);
+    FlightEvent* event = &ring[number & FLIGHT_MASK];
+    __atomic_store_n(&event->number, 0, __ATOMIC_RELAXED);
+    event->game = state == NULL ? 0 : (uint32_t)(uintptr_t)state;
+    event->type = type;
+    event->player = NO_PLAYER;
+    event->tileIndex = -1;
+    if (state != NULL) {
+        event->player = state->player;
+        event->tileIndex = state->tileIndex;
+    }
+    event->values[0] = a;
+    event->values[1] = b;
+    event->values[2] = c;
+    if (text != NULL) {
+        strncpy(event->text, text, FLIGHT_TEXT);
+    } else {
+        memset(event->text, 0, FLIGHT_TEXT);
+    }
+    __atomic_store_n(&event->number, number + 1, __ATOMIC_RELEASE);
+}
+
+void dump_flight_recorder(const char* reason) {
+    if (!enabled || __atomic_exchange_n(&dumped, 1, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+    int fd = open(flightPath, O_WRONLY | O_CREAT | O_TRUNC, FILE_MODE);
+    if (fd < 0) {
+        return;
+    }
+    uint64_t end = __atomic_load_n(&nextEvent, __ATOMIC_ACQUIRE);
+    uint64_t start = end > FLIGHT_EVENTS ? end - FLIGHT_EVENTS : 0;
+    char line[LINE_SIZE];
+    int length = 0;
+    add_text(line, &length, "fitz flight recorder: ", LINE_SIZE);
+    add_text(line, &length, reason, LINE_SIZE);
+    add_text(line, &length, "\nevent game type player tile a b c text\n",
+            LINE_SIZE);
+    write(fd, line, length);
+    for (uint64_t i = start; i < end; i++) {
+        FlightEvent* event = &ring[i & FLIGHT_MASK];
+        FlightEvent copy = *event;
+        // written over by a later event or never finished
+        if (__atomic_load_n(&event->number, __ATOMIC_ACQUIRE) != i + 1 ||
+                copy.number != i + 1 || copy.type < 0 ||
+                copy.type >= FLIGHT_TYPES) {
+            continue;
+        }
+        for (int j = 0; j < FLIGHT_TEXT; j++) {
+            // a new line in the text would start another event
+            if (copy.text[j] != '\0' && (unsigned char)copy.text[j] < ' ') {
+                copy.text[j] = '?';
+            }
+        }
+        length = 0;
+        add_number(line, &length, i);
+        add_number(line, &length, copy.game);
+        add_text(line, &length, typeNames[(int)copy.type], LINE_SIZE);
+        add_text(line, &length, " ", 1);
+        add_text(line, &length, &copy.player, 1);
+        add_text(line, &length, " ", 1);
+        add_number(line, &length, copy.tileIndex);
+        for (int j = 0; j < 3; j++) {
+            add_number(line, &length, copy.values[j]);
+        }
+        add_text(line, &length, copy.text, FLIGHT_TEXT);
+        add_text(line, &length, "\n", 1);
+        write(fd, line, length);
+    }
+    close(fd);
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void crash_handler(int signalNumber) {
+    char reason[LINE_SIZE];
+    int length = 0;
+    add_text(reason, &length, "signal ", sizeof(reason));
+    add_number(reason, &length, signalNumber);
+    reason[length] = '\0';
+    dump_flight_recorder(reason);
+    raise(signalNumber);
+}
+
+//
+static void add_text(char* line, int* length, const char* text, int count) {
+    for (int i = 0; i < count && text[i] != '\0' &&
+            *length < LINE_SIZE - 1; i++) {
+        line[(*length)++] = text[i];
+    }
+}
+
+//
+static void add_number(char* line, int* length, long number) {
+    char digits[NUMBER_SIZE];
+    int count = 0;
+    unsigned long value = number < 0 ? -(unsigned long)number : number;
+    do {
+        digits[count++] = '0' + value % DECIMAL;
+        value /= DECIMAL;
+    } while (value > 0);
+    if (number < 0 && *length < LINE_SIZE - 1) {
+        line[(*length)++] = '-';
+    }
+    while (count > 0 && *length < LINE_SIZE - 1) {
+        line[(*length)++] = digits[--count];
+    }
+    if (*length < LINE_SIZE - 1) {
+        line[(*length)++] = ' ';
+    }
+}
\ No newline at end of file
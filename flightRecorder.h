@@ -0,0 +1,58 @@
+/*
+ * flightRecorder.h
+ * Author: Michael Bossner
+ *
+ * Header file for flightRecorder.c
+ */
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdbool.h>
+
+#include "game.h"
+
+#define FLIGHT_TILES 0
+#define FLIGHT_MOVE 1
+#define FLIGHT_INPUT 2
+#define FLIGHT_SAVE 3
+#define FLIGHT_LOAD 4
+#define FLIGHT_TYPES 5
+
+/*
+ * Turns on the flight recorder for the rest of the program. The last events
+ * are written to the file when the program ends with an error or a signal
+ * that would crash it.
+ *
+ * path: Name of the file the events are written to
+ */
+void enable_flight_recorder(char* path);
+
+/*
+ * Adds an event to the flight recorder. Does nothing while it is off. Never
+ * blocks so it is safe to call from any thread.
+ *
+ * type: What happened. One of the FLIGHT_ defines
+ *
+ * state: The game it happened in. May be NULL
+ *
+ * a: First value of the event
+ *
+ * b: Second value of the event
+ *
+ * c: Third value of the event
+ *
+ * text: Text of the event. Only the start is kept. May be NULL
+ */
+void record_flight(int type, GameStateInfo* state, int a, int b, int c,
+        const char* text);
+
+/*
+ * Writes the events still in the flight recorder to its file. Only the first
+ * call writes anything. Safe to call from a signal handler.
+ *
+ * reason: Why the program is ending
+ */
+void dump_flight_recorder(const char* reason);
+
+#endif
\ No newline at end of file
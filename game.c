@@ -14,10 +14,18 @@
 #include "humanPlayer.h"
 #include "autoPlayer.h"
 #include "saveGame.h"
+#include "tileFit.h"
+#include "searchPlayer.h"
+#include "ponder.h"
+#include "stats.h"
+#include "trace.h"
+#include "flightRecorder.h"
+#include "memStats.h"
 
 #define SAVED 1
 #define TILE_ROW_MAX 4
 #define TILE_COLM_MAX 4
+#define WARMUP_TURNS 2
 
 ///////////////////////// Private Function Prototypes /////////////////////////
 
@@ -45,13 +53,6 @@ static int game_loop(GameStateInfo* state, LoadedTilefile* loadedFile);
  */
 static void create_board(GameStateInfo* state);
 
-/*
- * Prints a copy of the current state of the game board to the console.
- *
- * state: The current state of the game
- */
-static void print_board(GameStateInfo* state);
-
 /*
  * Moves to the next tile to be used for play and updates the current
  * state of the game. If there are no more tiles to be used the first tile
@@ -64,35 +65,31 @@ static void print_board(GameStateInfo* state);
 static void increment_tiles(LoadedTilefile* loadedFile, GameStateInfo* state);
 
 /*
- * Adds the last move made to the board and updates the game state.
- * This function does not care if the move is not a valid move.
- *
- * loadedFile: Information about the tilefile as well as a copy of all tiles
+ * Adds the current tile to the board for the current player at the position
+ * in state->inst.
  *
  * state: The current state of the game
  *
- * return: Returns 0 when completed
+ * undo: Where the cells changed are recorded. May be NULL
  */
-static int update_board(GameStateInfo* state);
-
-/*
- * Checks if there is a valid move available for the next tile to be used.
- *
- * state: The current state of the game
- *
- * return: Returns true if the the next tile cannot be placed on the board.
- *         Returns false if the next tile can be placed on the board.
- */
-static bool is_game_over(GameStateInfo* state);
+static void place_tile(GameStateInfo* state, MoveUndo* undo);
 
 //////////////////////////////// Functions ////////////////////////////////////
 
 int init_game(GameStateInfo* state, LoadedTilefile* loadedFile, int gameType) {
+    prepare_game(state, loadedFile, gameType);
+    game_loop(state, loadedFile);
+    end_game(state);
+    return EXIT;
+}
+
+void prepare_game(GameStateInfo* state, LoadedTilefile* loadedFile, 
+        int gameType) {
+    state->tiles = loadedFile;
     switch (gameType) {
         case NEW_GAME:
             create_board(state);
-            loadedFile->index = 0;
-            state->tileIndex = loadedFile->index;
+            state->tileIndex = 0;
             state->player = PLAYER_1;
             state->turn = 0;         
 
@@ -106,31 +103,58 @@ int init_game(GameStateInfo* state, LoadedTilefile* loadedFile, int gameType) {
             state->instA2P2[COLM] = MAX_MOVE_C;
             state->instA2P2[ROW] = MAX_MOVE_R;
             state->instA2P2[ROTATE] = 0;
-            state->tile = loadedFile->loadedTiles[loadedFile->index];
+            state->tile = loadedFile->loadedTiles[state->tileIndex];
+            state->quiet = false;
+            state->moveCount = 0;
+            state->search = NULL;
+            init_tile_fit(state);
     }
-    game_loop(state, loadedFile);
-    return EXIT;
+}
+
+void end_game(GameStateInfo* state) {
+    free_tile_fit(state);
+    free_search(state);
+    free_board(state->board);
+    state->board = NULL;
+}
+
+char** alloc_board(int height, int width) {
+    // the cells follow the rows so a board with no rows is still one block
+    char** board = mem_malloc(MEM_BOARD, sizeof(char*) * height +
+            sizeof(char) * height * width);
+    char* cells = (char*)&board[height];
+    for (int colm = 0; colm < height; colm++) {
+        board[colm] = &cells[colm * width];
+    }
+    return board;
+}
+
+void free_board(char** board) {
+    mem_free(MEM_BOARD, board);
 }
 
 bool is_move_valid(char** tile, GameStateInfo* state, int* inst) {
     int y = MIN_MOVE;
     int x = MIN_MOVE;
+    int inspected = 0;
+    bool valid = true;
     // looking for a '!' in the tile to test
-    for (int tileColm = 0; tileColm <= TILE_COLM_MAX; tileColm++) {
-        for (int tileRow = 0; tileRow <= TILE_ROW_MAX; tileRow++) {
+    for (int tileColm = 0; tileColm <= TILE_COLM_MAX && valid; tileColm++) {
+        for (int tileRow = 0; tileRow <= TILE_ROW_MAX && valid; tileRow++) {
             if (tile[tileColm][tileRow] == '!') {               
+                inspected++;
                 // Checking if '!' is out of bounds
                 if ((inst[COLM] + y) < 0 
                         || ((inst[ROW] + x) < 0)
                         || ((inst[COLM] + y) >= state->height) 
                         || ((inst[ROW] + x) >= state->width)) {             
-                    return false;
+                    valid = false;
                 // checking if '!' overrides another move
                 } else if (state->board[(inst[COLM] + y)]
                         [(inst[ROW] + x)] == PLAYER_1 || 
                         (state->board[(inst[COLM] + y)]
                         [(inst[ROW] + x)] == PLAYER_2)) {                   
-                    return false;
+                    valid = false;
                 }
             }
             x++;
@@ -138,54 +162,158 @@ bool is_move_valid(char** tile, GameStateInfo* state, int* inst) {
         x = MIN_MOVE;
         y++;
     }
-    return true;
+    count_stat(COUNTER_MOVE_CHECKS, 1);
+    count_stat(COUNTER_CELLS_INSPECTED, inspected);
+    return valid;
+}
+
+void print_board(GameStateInfo* state) {
+    PhaseStart start;
+    start_phase(&start);
+    // prints every character contained on the board
+    for (int colm = 0; colm < state->height; colm++) {
+        for (int row = 0; row < state->width; row++) {
+            printf("%c", state->board[colm][row]);
+        }
+        // new line after every row is printed
+        printf("\n");
+    }
+    end_phase(PHASE_PRINT_BOARD, &start);
+}
+
+int update_board(GameStateInfo* state) {
+    PhaseStart start;
+    start_phase(&start);
+    record_flight(FLIGHT_MOVE, state, state->inst[COLM], state->inst[ROW],
+            state->inst[ROTATE], NULL);
+    place_tile(state, NULL);
+    state->moveCount++;
+    end_phase(PHASE_UPDATE_BOARD, &start);
+    return EXIT;
+}
+
+bool is_game_over(GameStateInfo* state) {
+    PhaseStart start;
+    start_phase(&start);
+    bool over = !can_tile_fit(state);
+    end_phase(PHASE_GAME_OVER, &start);
+    return over;
+}
+
+bool play_turn(GameStateInfo* state) {
+    trace_begin(TRACE_TURN, state);
+    start_mem_turn();
+    // each player sets up its search on its first turn
+    bool warmup = state->moveCount < WARMUP_TURNS;
+    if (!state->quiet) {
+        trace_begin(TRACE_RENDER, state);
+        print_board(state);
+        trace_end(TRACE_RENDER);
+    }
+    // check for game over
+    trace_begin(TRACE_GAME_OVER, state);
+    bool over = is_game_over(state);
+    trace_end(TRACE_GAME_OVER);
+    if (over) {
+        if (!state->quiet) {
+            printf("Player %c wins\n", state->player);
+        }
+        end_mem_turn(warmup);
+        trace_end(TRACE_TURN);
+        return true;
+    }
+    // get instructions for turn
+    trace_begin(TRACE_MOVE, state);
+    if (!state->turn) {
+        // Player 1s turn
+        state->player = PLAYER_1;           
+        if (state->p1Type == 'h') {
+            print_tile(state->tiles, state->tileIndex);
+            start_ponder(state);
+            process_h(state);
+            stop_ponder(state);
+        } else {
+            process_ap(state);              
+        }
+    } else {
+        // Player 2s turn
+        state->player = PLAYER_2;
+        if (state->p2Type == 'h') {
+            print_tile(state->tiles, state->tileIndex);
+            start_ponder(state);
+            process_h(state);
+            stop_ponder(state);
+        } else {
+            process_ap(state);              
+        }
+    }
+    trace_end(TRACE_MOVE);
+    trace_begin(TRACE_UPDATE, state);
+    end_turn(state);
+    trace_end(TRACE_UPDATE);
+    end_mem_turn(warmup);
+    trace_end(TRACE_TURN);
+    return false;
+}
+
+void end_turn(GameStateInfo* state) {
+    state->turn = state->turn == P1 ? P2 : P1;
+    // update board and move to the next tile in the game
+    update_board(state);
+    increment_tiles(state->tiles, state);
+}
+
+void make_move(GameStateInfo* state, MoveUndo* undo) {
+    undo->turn = state->turn;
+    undo->player = state->player;
+    undo->tileIndex = state->tileIndex;
+    for (int i = 0; i < INST_MAX; i++) {
+        undo->inst[i] = state->inst[i];
+        undo->instA2P1[i] = state->instA2P1[i];
+        undo->instA2P2[i] = state->instA2P2[i];
+    }
+    undo->cellCount = 0;
+    undo->fitMark = mark_tile_fit(state);
+    state->player = state->turn == P1 ? PLAYER_1 : PLAYER_2;
+    state->turn = state->turn == P1 ? P2 : P1;
+    place_tile(state, undo);
+    state->moveCount++;
+    increment_tiles(state->tiles, state);
+}
+
+void unmake_move(GameStateInfo* state, MoveUndo* undo) {
+    for (int i = 0; i < undo->cellCount; i++) {
+        state->board[undo->cells[i] / state->width]
+                [undo->cells[i] % state->width] = undo->was[i];
+    }
+    state->turn = undo->turn;
+    state->player = undo->player;
+    state->tileIndex = undo->tileIndex;
+    state->tile = state->tiles->loadedTiles[state->tileIndex];
+    for (int i = 0; i < INST_MAX; i++) {
+        state->inst[i] = undo->inst[i];
+        state->instA2P1[i] = undo->instA2P1[i];
+        state->instA2P2[i] = undo->instA2P2[i];
+    }
+    state->moveCount--;
+    // what was found about where shapes fit assumed cells stay taken
+    restore_tile_fit(state, undo->fitMark);
 }
 
 ////////////////////////////// Private Functions //////////////////////////////
 //
 static int game_loop(GameStateInfo* state, LoadedTilefile* loadedFile) {
     FOREVER {
-        print_board(state);
-        // check for game over
-        if (is_game_over(state)) {
-            printf("Player %c wins\n", state->player);
+        if (play_turn(state)) {
             return EXIT;
         }
-        // get instructions for turn
-        if (!state->turn) {
-            // Player 1s turn
-            state->player = PLAYER_1;           
-            if (state->p1Type == 'h') {
-                print_tile(loadedFile);
-                process_h(state);
-            } else {
-                process_ap(state);              
-            }
-            state->turn = P2;
-        } else {
-            // Player 2s turn
-            state->player = PLAYER_2;
-            if (state->p2Type == 'h') {
-                print_tile(loadedFile);
-                process_h(state);
-            } else {
-                process_ap(state);              
-            }
-            state->turn = P1;
-        }
-        // update board and move to the next tile in the game
-        update_board(state);
-        increment_tiles(loadedFile, state);
     }
 }
 
 //
 static void create_board(GameStateInfo* state) {
     // allocate memory the size of the board
-    state->board = malloc(sizeof(char*) * state->height);
-    for (int i = 0; i < state->height; i++) {
-        state->board[i] = malloc(sizeof(char) * state->width);
-    }
+    state->board = alloc_board(state->height, state->width);
     // place a '.' in all positions on the board
     for (int colm = 0; colm < state->height; colm++) {
         for (int row = 0; row < state->width; row++) {
@@ -194,69 +322,39 @@ static void create_board(GameStateInfo* state) {
     }
 }
 
-//
-static void print_board(GameStateInfo* state) {
-    // prints every character contained on the board
-    for (int colm = 0; colm < state->height; colm++) {
-        for (int row = 0; row < state->width; row++) {
-            printf("%c", state->board[colm][row]);
-        }
-        // new line after every row is printed
-        printf("\n");
-    }
-}
 
 //
 static void increment_tiles(LoadedTilefile* loadedFile, GameStateInfo* state) {
-    if (loadedFile->index >= loadedFile->size) {
-        loadedFile->index = 0;
+    // the loaded tiles are shared between games so only the state changes
+    if (state->tileIndex >= loadedFile->size) {
+        state->tileIndex = 0;
     } else {
-        loadedFile->index++;
+        state->tileIndex++;
     }
-    state->tile = loadedFile->loadedTiles[loadedFile->index];
-    state->tileIndex = loadedFile->index;
+    state->tile = loadedFile->loadedTiles[state->tileIndex];
 }
 
 //
-static int update_board(GameStateInfo* state) {
-    char** tile = rotate_tile(state->tile, state->inst[ROTATE], CALL);
+static void place_tile(GameStateInfo* state, MoveUndo* undo) {
+    char** tile = get_rotated_tile(state->tiles, state->tileIndex,
+            state->inst[ROTATE]);
     int y = MIN_MOVE;
     int x = MIN_MOVE;
     // looking for a '!' on the tile then adding it to the board
     for (int tileColm = 0; tileColm <= TILE_COLM_MAX; tileColm++) {
         for (int tileRow = 0; tileRow <= TILE_ROW_MAX; tileRow++) {
             if (tile[tileColm][tileRow] == '!') {
-                state->board[state->inst[COLM] + y][state->inst[ROW] + x] =
-                        state->player;
+                int colm = state->inst[COLM] + y;
+                int row = state->inst[ROW] + x;
+                if (undo != NULL) {
+                    undo->cells[undo->cellCount] = colm * state->width + row;
+                    undo->was[undo->cellCount++] = state->board[colm][row];
+                }
+                state->board[colm][row] = state->player;
             }
             x++;
         }
         x = MIN_MOVE;
         y++;        
     }
-    return EXIT;
-}
-
-//
-static bool is_game_over(GameStateInfo* state) {
-    int inst[INST_MAX];
-    // increments through all tile rotations
-    for (inst[ROTATE] = 0; inst[ROTATE] <= ROTATE_270; 
-            inst[ROTATE] += ROTATE_90) {
-        char** rotatedTile = rotate_tile(state->tile, inst[ROTATE], CALL);
-        // increments through every column on the board
-        for (inst[COLM] = MIN_MOVE; inst[COLM] < MAX_MOVE_C;
-                inst[COLM]++) {
-            // increments through every row on the board
-            for (inst[ROW] = MIN_MOVE; 
-                    inst[ROW] < MAX_MOVE_R; inst[ROW]++) {
-                if (is_move_valid(rotatedTile, state, inst)) {
-                    // there is a valid move available
-                    return false;
-                }
-            }
-        }
-    }
-    // no valid moves are available
-    return true;
 }
\ No newline at end of file
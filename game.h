@@ -29,8 +29,13 @@
 #define LOAD_GAME 5
 #define P1 0
 #define P2 1
+#define MAX_BOARD_SIZE 999
 
 typedef struct GameStateInfo GameStateInfo;
+typedef struct MoveUndo MoveUndo;
+typedef struct ShapeFit ShapeFit;
+typedef struct FitChange FitChange;
+typedef struct Search Search;
 
 /*
  * Contains all relevant information about the current state of the game
@@ -47,6 +52,31 @@ struct GameStateInfo {
     char** board; // The game board
     char** tile; // copy of the current tile to be used
     int tileIndex; // index of the current tile to be used
+    LoadedTilefile* tiles; // All tiles loaded for use in the game
+    int moveCount; // Moves made since the game was started or loaded
+    ShapeFit* shapeFits; // What is known about where each shape fits
+    /* Each change to shapeFits since make_move was first used, oldest first */
+    FitChange* fitLog;
+    int fitLogCount; // Number of changes in fitLog
+    int fitLogSize; // Changes fitLog has room for
+    bool logFits; // Whether changes to shapeFits are logged
+    bool quiet; // Nothing is printed during the game when set
+    Search* search; // What the search player keeps between moves
+};
+
+/*
+ * Everything make_move changed so that unmake_move can put it back
+ */
+struct MoveUndo {
+    int cellCount; // Number of cells the tile was placed on
+    int cells[TILE_CELLS]; // Each cell the tile was placed on
+    char was[TILE_CELLS]; // What each cell held before
+    int turn; // turn before the move
+    char player; // player before the move
+    int tileIndex; // tileIndex before the move
+    /* Move instructions before the move */
+    int inst[INST_MAX], instA2P1[INST_MAX], instA2P2[INST_MAX];
+    int fitMark; // fitLogCount when the move was made
 };
 
 /*
@@ -64,6 +94,121 @@ struct GameStateInfo {
  */
 int init_game(GameStateInfo* state, LoadedTilefile* loadedFile, int gameType);
 
+/*
+ * Initializes the game state with information to be used during play
+ * without starting the game loop.
+ *
+ * state: The current state of the game
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ *
+ * gameType: The game type specifies what type of game you are starting. 
+ *         Either 6 for a New Game || 5 for game loaded from a save file.
+ */
+void prepare_game(GameStateInfo* state, LoadedTilefile* loadedFile, 
+        int gameType);
+
+/*
+ * Allocates a board. The rows and their cells share one block so a board is
+ * one allocation whatever its size. Free it with free_board.
+ *
+ * height: Number of rows
+ *
+ * width: Number of cells in each row
+ *
+ * return: Returns the rows of the board. The cells are not set
+ */
+char** alloc_board(int height, int width);
+
+/*
+ * Frees a board allocated by alloc_board.
+ *
+ * board: The board. May be NULL
+ */
+void free_board(char** board);
+
+/*
+ * Frees the board and everything else created for a game.
+ *
+ * state: The current state of the game
+ */
+void end_game(GameStateInfo* state);
+
+/*
+ * Plays a single turn of the game. Prints the board, checks whether the game
+ * is over and if not gets the current players move and adds it to the board.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns true if the game is over. Returns false if the turn was
+ *         played.
+ *
+ * error_10: EOF is received while waiting for input from stdin. Game ends.
+ *
+ * err_save_fail: The game could not be saved. This does not end the game.
+ */
+bool play_turn(GameStateInfo* state);
+
+/*
+ * Finishes the current players turn by adding their move to the board,
+ * handing the turn to the other player and moving to the next tile.
+ *
+ * state: The current state of the game. inst holds the move to be made and
+ *         player is the player making it
+ */
+void end_turn(GameStateInfo* state);
+
+/*
+ * Makes the move in state->inst for the player whose turn it is the same way
+ * end_turn does, recording what it changes. Only the cells under the tile
+ * are recorded so a move and its undo both take as long as the tile has
+ * cells. This function does not care if the move is not a valid move.
+ *
+ * state: The current state of the game
+ *
+ * undo: Where what was changed is recorded
+ */
+void make_move(GameStateInfo* state, MoveUndo* undo);
+
+/*
+ * Takes back the last move made by make_move, leaving the game as it was
+ * before the move. What was found about where shapes fit since the move is
+ * put back as it was too. Moves must be taken back in the opposite order to
+ * the one they were made in.
+ *
+ * state: The current state of the game
+ *
+ * undo: What make_move recorded for the move
+ */
+void unmake_move(GameStateInfo* state, MoveUndo* undo);
+
+/*
+ * Prints a copy of the current state of the game board to the console.
+ *
+ * state: The current state of the game
+ */
+void print_board(GameStateInfo* state);
+
+/*
+ * Adds the last move made to the board and updates the game state.
+ * This function does not care if the move is not a valid move.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns 0 when completed
+ */
+int update_board(GameStateInfo* state);
+
+/*
+ * Checks if there is a valid move available for the next tile to be used.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns true if the the next tile cannot be placed on the board.
+ *         Returns false if the next tile can be placed on the board.
+ */
+bool is_game_over(GameStateInfo* state);
+
 /*
  * Checks whether a tile and a set of move instructions is allowed to be 
  * placed on the current board state.
@@ -0,0 +1,240 @@
+/*
+ * generator.c
+ * Author: Michael Bossner
+ *
+ * This file contains functions for generating tiles and save files for
+ * testing and profiling the game at any scale.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "generator.h"
+#include "tilefile.h"
+#include "options.h"
+#include "error.h"
+#include "game.h"
+#include "stats.h"
+#include "flightRecorder.h"
+#include "memStats.h"
+
+#define DEFAULT_SEED 1
+#define DEFAULT_DENSITY 0.3
+#define DEFAULT_FILL 0.5
+#define SEED_MIX 0x9E3779B97F4A7C15ULL
+#define RANDOM_MULT 0x2545F4914F6CDD1DULL
+#define RANDOM_SHIFT 32
+#define UNIT_SCALE 4294967296.0
+/* Line 1 of a save file holds at most 13 characters */
+#define MAX_SAVE_INDEX 100
+#define GEN_TILES_COUNT 2
+#define GEN_SAVE_HEIGHT 2
+#define GEN_SAVE_WIDTH 3
+#define GEN_FIELDS 3
+#define USAGE "fitz --gen-tiles count [--seed seed] [--density p]\n" \
+        "       fitz --gen-save height width [--fill f] [--seed seed] " \
+        "[--tiles count]"
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Reads the options shared by both generator modes.
+ *
+ * argc: Number of command line arguments
+ *
+ * argv: The command line arguments
+ *
+ * first: Index of the first option
+ *
+ * chanceName: Name of the option for the chance. --density or --fill
+ *
+ * seed: Where the seed is stored
+ *
+ * chance: Where the density or fill is stored
+ *
+ * tileCount: Where the tile count is stored. NULL if the mode has none
+ *
+ * error_usage: An option is invalid. Program ends.
+ */
+static void parse_gen_options(int argc, char** argv, int first, 
+        char* chanceName, unsigned long* seed, double* chance, 
+        int* tileCount);
+
+/*
+ * Checks a chance is between 0 and 1.
+ *
+ * chance: The chance to be checked
+ *
+ * return: Returns true if the chance is valid
+ */
+static bool is_chance_valid(double chance);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+void seed_random(Random* random, unsigned long seed) {
+    // state must never be 0 for xorshift
+    random->state = ((uint64_t)seed + 1) * SEED_MIX;
+    if (random->state == 0) {
+        random->state = SEED_MIX;
+    }
+}
+
+uint32_t next_random(Random* random) {
+    random->state ^= random->state >> 12;
+    random->state ^= random->state << 25;
+    random->state ^= random->state >> 27;
+    return (uint32_t)((random->state * RANDOM_MULT) >> RANDOM_SHIFT);
+}
+
+double random_unit(Random* random) {
+    return next_random(random) / UNIT_SCALE;
+}
+
+void generate_tiles(LoadedTilefile* loadedFile, int count, unsigned long seed,
+        double density) {
+    Random random;
+    seed_random(&random, seed);
+    loadedFile->size = count - 1;
+    loadedFile->loadedTiles = mem_malloc(MEM_TILEFILE, sizeof(char**) * count);
+    for (int i = 0; i < count; i++) {
+        char** tile = alloc_tile();
+        bool empty = true;
+        for (int colm = 0; colm < TILE_DIM; colm++) {
+            for (int row = 0; row < TILE_DIM; row++) {
+                if (random_unit(&random) < density) {
+                    tile[colm][row] = '!';
+                    empty = false;
+                } else {
+                    tile[colm][row] = ',';
+                }
+            }
+            tile[colm][TILE_DIM] = '\0';
+        }
+        if (empty) {
+            // a tile with no '!' can always be placed so one is added
+            tile[next_random(&random) % TILE_DIM]
+                    [next_random(&random) % TILE_DIM] = '!';
+        }
+        loadedFile->loadedTiles[i] = tile;
+    }
+    index_tiles(loadedFile);
+}
+
+void generate_save(FILE* file, int height, int width, double fill, 
+        unsigned long seed, int tileCount) {
+    Random random;
+    seed_random(&random, seed);
+    if (tileCount > MAX_SAVE_INDEX) {
+        tileCount = MAX_SAVE_INDEX;
+    }
+    fprintf(file, "%u %u %d %d\n", next_random(&random) % tileCount,
+            next_random(&random) % 2, height, width);
+    for (int colm = 0; colm < height; colm++) {
+        for (int row = 0; row < width; row++) {
+            if (random_unit(&random) >= fill) {
+                fputc('.', file);
+            } else if (next_random(&random) % 2) {
+                fputc(PLAYER_2, file);
+            } else {
+                fputc(PLAYER_1, file);
+            }
+        }
+        fputc('\n', file);
+    }
+}
+
+void load_tile_source(LoadedTilefile* loadedFile) {
+    PhaseStart start;
+    start_phase(&start);
+    char* name = loadedFile->tilefileName;
+    record_flight(FLIGHT_TILES, NULL, 0, 0, 0, name);
+    if (strncmp(name, GEN_SOURCE, strlen(GEN_SOURCE)) != 0) {
+        load_tilefile(loadedFile);
+        end_phase(PHASE_LOAD_TILES, &start);
+        return;
+    }
+    // gen:count:seed:density
+    char spec[strlen(name) + 1];
+    strcpy(spec, name + strlen(GEN_SOURCE));
+    char* fields[GEN_FIELDS];
+    int fieldCount = 0;
+    for (char* field = strtok(spec, ":"); field != NULL && 
+            fieldCount < GEN_FIELDS; field = strtok(NULL, ":")) {
+        fields[fieldCount++] = field;
+    }
+    int count;
+    unsigned long seed;
+    double density;
+    if (fieldCount != GEN_FIELDS || !parse_int(fields[0], &count) || 
+            count <= 0 || !parse_ulong(fields[1], &seed) || 
+            !parse_double(fields[2], &density) || !is_chance_valid(density)) {
+        error_2();
+    }
+    generate_tiles(loadedFile, count, seed, density);
+    end_phase(PHASE_LOAD_TILES, &start);
+}
+
+int generator_main(int argc, char** argv) {
+    unsigned long seed = DEFAULT_SEED;
+    if (strcmp(argv[1], GEN_TILES) == 0) {
+        double density = DEFAULT_DENSITY;
+        int count;
+        if (argc <= GEN_TILES_COUNT || 
+                !parse_int(argv[GEN_TILES_COUNT], &count) || count <= 0) {
+            error_usage(USAGE);
+        }
+        parse_gen_options(argc, argv, GEN_TILES_COUNT + 1, "--density", 
+                &seed, &density, NULL);
+        LoadedTilefile loadedFile;
+        generate_tiles(&loadedFile, count, seed, density);
+        write_tilefile(&loadedFile, stdout);
+        free_loaded_tiles(&loadedFile);
+    } else {
+        double fill = DEFAULT_FILL;
+        int tileCount = 1;
+        int height, width;
+        if (argc <= GEN_SAVE_WIDTH || 
+                !parse_int(argv[GEN_SAVE_HEIGHT], &height) || 
+                !parse_int(argv[GEN_SAVE_WIDTH], &width) || height <= 0 ||
+                width <= 0 || height > MAX_BOARD_SIZE || 
+                width > MAX_BOARD_SIZE) {
+            error_usage(USAGE);
+        }
+        parse_gen_options(argc, argv, GEN_SAVE_WIDTH + 1, "--fill", &seed, 
+                &fill, &tileCount);
+        generate_save(stdout, height, width, fill, seed, tileCount);
+    }
+    return EXIT;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void parse_gen_options(int argc, char** argv, int first, 
+        char* chanceName, unsigned long* seed, double* chance, 
+        int* tileCount) {
+    for (int i = first; i < argc; i += 2) {
+        if (is_option(argc, argv, i, "--seed")) {
+            if (!parse_ulong(argv[i + 1], seed)) {
+                error_usage(USAGE);
+            }
+        } else if (is_option(argc, argv, i, chanceName)) {
+            if (!parse_double(argv[i + 1], chance) || 
+                    !is_chance_valid(*chance)) {
+                error_usage(USAGE);
+            }
+        } else if (tileCount != NULL && 
+                is_option(argc, argv, i, "--tiles")) {
+            if (!parse_int(argv[i + 1], tileCount) || *tileCount <= 0) {
+                error_usage(USAGE);
+            }
+        } else {
+            error_usage(USAGE);
+        }
+    }
+}
+
+//
+static bool is_chance_valid(double chance) {
+    return chance >= 0 && chance <= 1;
+}
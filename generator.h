@@ -0,0 +1,118 @@
+/*
+ * generator.h
+ * Author: Michael Bossner
+ *
+ * Header file for generator.c
+ */
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "tilefile.h"
+
+#define GEN_TILES "--gen-tiles"
+#define GEN_SAVE "--gen-save"
+#define GEN_SOURCE "gen:"
+
+typedef struct Random Random;
+
+/*
+ * A seeded pseudo random number generator (xorshift64*). The same seed 
+ * always gives the same numbers on every machine.
+ */
+struct Random {
+    uint64_t state; // Current state of the generator. Never 0
+};
+
+/*
+ * Seeds a random number generator.
+ *
+ * random: The generator to be seeded
+ *
+ * seed: The seed to be used
+ */
+void seed_random(Random* random, unsigned long seed);
+
+/*
+ * Gets the next random number from a generator.
+ *
+ * random: The generator to be used
+ *
+ * return: Returns a random 32 bit number
+ */
+uint32_t next_random(Random* random);
+
+/*
+ * Gets a random number between 0 and 1 from a generator.
+ *
+ * random: The generator to be used
+ *
+ * return: Returns a random number in the range [0, 1)
+ */
+double random_unit(Random* random);
+
+/*
+ * Generates tiles straight into memory in place of loading a tilefile.
+ * Every tile has at least one '!' cell.
+ *
+ * loadedFile: Where the generated tiles are stored
+ *
+ * count: How many tiles to generate
+ *
+ * seed: Seed for the tiles. The same seed always gives the same tiles
+ *
+ * density: Chance of each cell in a tile being a '!'
+ */
+void generate_tiles(LoadedTilefile* loadedFile, int count, unsigned long seed,
+        double density);
+
+/*
+ * Writes a save file with a randomly filled board.
+ *
+ * file: The file to write the save too
+ *
+ * height: Height of the board
+ *
+ * width: Width of the board
+ *
+ * fill: Chance of each cell on the board being taken by a player
+ *
+ * seed: Seed for the board. The same seed always gives the same save
+ *
+ * tileCount: Number of tiles in the tilefile the save is to be used with
+ */
+void generate_save(FILE* file, int height, int width, double fill, 
+        unsigned long seed, int tileCount);
+
+/*
+ * Loads the tiles named by loadedFile->tilefileName. Names starting with 
+ * "gen:" are generated in memory in the form gen:count:seed:density 
+ * instead of being read from a file.
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ *
+ * error_2: The tilefile cannot be opened or the gen: name is invalid.
+ *
+ * error_3: The tilefile contents are invalid.
+ */
+void load_tile_source(LoadedTilefile* loadedFile);
+
+/*
+ * Runs one of the generator modes from the command line.
+ * fitz --gen-tiles count [--seed seed] [--density p]
+ * fitz --gen-save height width [--fill f] [--seed seed] [--tiles count]
+ *
+ * argc: Number of command line arguments
+ *
+ * argv: The command line arguments
+ *
+ * return: Returns 0 when completed
+ *
+ * error_usage: The arguments are invalid. Program ends.
+ */
+int generator_main(int argc, char** argv);
+
+#endif
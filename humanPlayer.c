@@ -14,6 +14,7 @@
 #include "error.h"
 #include "saveGame.h"
 #include "parseFile.h"
+#include "flightRecorder.h"
 
 #define ZERO 48
 #define NINE 57
@@ -24,9 +25,20 @@
 #define A 1
 #define V 2
 #define E 3
+#define INPUT_TEXT 32
 
 ///////////////////////// Private Function Prototypes /////////////////////////
 
+/*
+ * Adds a line of input to the flight recorder with its words joined by
+ * spaces.
+ *
+ * state: The current state of the game
+ *
+ * splitStdIn: The words of the line
+ */
+static void record_input(GameStateInfo* state, FileCont* splitStdIn);
+
 /*
  * Checks the input given is a valid command for the game.
  * Updates the game state if the input is a valid move command.
@@ -77,9 +89,14 @@ void process_h(GameStateInfo* state) {
         FileCont splitStdIn;
         // ask for input
         split_stdin(&splitStdIn);
+        record_input(state, &splitStdIn);
         // check input
-        if (is_input_valid(splitStdIn.sizeOfOut, splitStdIn.output, state)) {
-            char** tile = rotate_tile(state->tile, state->inst[ROTATE], CALL);
+        int valid = is_input_valid(splitStdIn.sizeOfOut, splitStdIn.output,
+                state);
+        free_file_cont(&splitStdIn);
+        if (valid) {
+            char** tile = get_rotated_tile(state->tiles, state->tileIndex,
+                    state->inst[ROTATE]);
             // input is valid check move instructions
             if (is_move_valid(tile, state, state->inst)) {
                 break;
@@ -89,6 +106,18 @@ void process_h(GameStateInfo* state) {
 }
 
 ////////////////////////////// Private Functions //////////////////////////////
+//
+static void record_input(GameStateInfo* state, FileCont* splitStdIn) {
+    char line[INPUT_TEXT] = "";
+    int length = 0;
+    for (int i = 0; i < splitStdIn->sizeOfOut && length < INPUT_TEXT - 1;
+            i++) {
+        length += snprintf(&line[length], INPUT_TEXT - length, "%s%s",
+                i == 0 ? "" : " ", splitStdIn->output[i]);
+    }
+    record_flight(FLIGHT_INPUT, state, splitStdIn->sizeOfOut, 0, 0, line);
+}
+
 //
 static int is_input_valid(int sizeOfOut, char** input, GameStateInfo* state) {
     switch (sizeOfOut) {
@@ -0,0 +1,362 @@
+/*
+ * libfitz.c
+ * Author: Michael Bossner
+ *
+ * This file contains the public interface of libfitz declared in fitz.h.
+ * It wraps the game so that it can be driven one move at a time without
+ * reading stdin, printing or ending the process.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fitz.h"
+#include "game.h"
+#include "tilefile.h"
+#include "tileFit.h"
+#include "saveGame.h"
+#include "autoPlayer.h"
+#include "memStats.h"
+
+#define UNDO_START 64
+
+/*
+ * Tiles that can be shared by many games
+ */
+struct FitzTiles {
+    LoadedTilefile loaded; // The loaded tiles
+};
+
+/*
+ * A single game
+ */
+struct FitzGame {
+    GameStateInfo state; // The state of the game
+    MoveUndo* undos; // What each move made changed, oldest first
+    int undoCount; // Number of moves that can be taken back
+    int undoSize; // Number of records undos has room for
+};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Reads tiles from an open file.
+ *
+ * file: The file to be read. Closed once read
+ *
+ * tiles: Where the loaded tiles are returned
+ *
+ * return: FITZ_OK or FITZ_ERR_TILES
+ */
+static int read_tiles(FILE* file, FitzTiles** tiles);
+
+/*
+ * Checks a player type can be used by a library game.
+ *
+ * type: The player type
+ *
+ * return: Returns true if the type is FITZ_HUMAN or an automatic player
+ */
+static bool is_type_valid(char type);
+
+/*
+ * Gets the name of the player whose turn it is.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns the name of the player
+ */
+static char turn_player(GameStateInfo* state);
+
+/*
+ * Makes the move in state->inst for the current player and keeps what it
+ * changed so it can be taken back.
+ *
+ * game: The game
+ */
+static void push_move(FitzGame* game);
+
+/*
+ * Sets up the undo stack of a new game.
+ *
+ * game: The game
+ */
+static void init_undos(FitzGame* game);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+int fitz_tiles_load(const char* path, FitzTiles** tiles) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return FITZ_ERR_ACCESS;
+    }
+    return read_tiles(file, tiles);
+}
+
+int fitz_tiles_from_buffer(const char* data, size_t size, FitzTiles** tiles) {
+    if (size == 0) {
+        return FITZ_ERR_TILES;
+    }
+    // the buffer is only read
+    FILE* file = fmemopen((void*)data, size, "r");
+    if (file == NULL) {
+        return FITZ_ERR_TILES;
+    }
+    return read_tiles(file, tiles);
+}
+
+void fitz_tiles_free(FitzTiles* tiles) {
+    free_loaded_tiles(&tiles->loaded);
+    mem_free(MEM_LIBRARY, tiles);
+}
+
+int fitz_game_new(FitzTiles* tiles, int height, int width, char p1Type, 
+        char p2Type, FitzGame** game) {
+    if (!is_type_valid(p1Type) || !is_type_valid(p2Type)) {
+        return FITZ_ERR_PLAYER;
+    } else if (height <= 0 || height > MAX_BOARD_SIZE || width <= 0 || 
+            width > MAX_BOARD_SIZE) {
+        return FITZ_ERR_DIMENSIONS;
+    }
+    FitzGame* newGame = mem_malloc(MEM_LIBRARY, sizeof(FitzGame));
+    newGame->state.p1Type = p1Type;
+    newGame->state.p2Type = p2Type;
+    newGame->state.height = height;
+    newGame->state.width = width;
+    prepare_game(&newGame->state, &tiles->loaded, NEW_GAME);
+    newGame->state.quiet = true;
+    init_undos(newGame);
+    *game = newGame;
+    return FITZ_OK;
+}
+
+int fitz_game_load(FitzTiles* tiles, const char* data, size_t size, 
+        char p1Type, char p2Type, FitzGame** game) {
+    if (!is_type_valid(p1Type) || !is_type_valid(p2Type)) {
+        return FITZ_ERR_PLAYER;
+    } else if (size == 0) {
+        return FITZ_ERR_SAVE;
+    }
+    FILE* file = fmemopen((void*)data, size, "r");
+    if (file == NULL) {
+        return FITZ_ERR_SAVE;
+    }
+    FitzGame* newGame = mem_malloc(MEM_LIBRARY, sizeof(FitzGame));
+    GameStateInfo* state = &newGame->state;
+    int status = read_save(file, state, &tiles->loaded);
+    fclose(file);
+    if (status != SAVE_LOADED) {
+        mem_free(MEM_LIBRARY, newGame);
+        return FITZ_ERR_SAVE;
+    }
+    state->p1Type = p1Type;
+    state->p2Type = p2Type;
+    state->player = turn_player(state);
+    prepare_game(state, &tiles->loaded, LOAD_GAME);
+    state->quiet = true;
+    init_undos(newGame);
+    *game = newGame;
+    return FITZ_OK;
+}
+
+int fitz_game_save(FitzGame* game, char* buffer, size_t size, 
+        size_t* written) {
+    char* save;
+    size_t saveSize;
+    FILE* file = open_memstream(&save, &saveSize);
+    write_save(file, &game->state);
+    fclose(file);
+    *written = saveSize;
+    if (saveSize > size) {
+        free(save);
+        return FITZ_ERR_BUFFER;
+    }
+    memcpy(buffer, save, saveSize);
+    free(save);
+    return FITZ_OK;
+}
+
+int fitz_game_is_over(FitzGame* game) {
+    return is_game_over(&game->state);
+}
+
+char fitz_game_player(FitzGame* game) {
+    char player = turn_player(&game->state);
+    // the last player to move is the winner. Only the turn is kept in a
+    // save so the winner is worked out from it
+    if (is_game_over(&game->state)) {
+        return player == PLAYER_1 ? PLAYER_2 : PLAYER_1;
+    }
+    return player;
+}
+
+int fitz_game_tile_index(FitzGame* game) {
+    return game->state.tileIndex;
+}
+
+char fitz_game_cell(FitzGame* game, int colm, int row) {
+    if (colm < 0 || row < 0 || colm >= game->state.height || 
+            row >= game->state.width) {
+        return '\0';
+    }
+    return game->state.board[colm][row];
+}
+
+int fitz_game_legal_moves(FitzGame* game, FitzMove* moves, int max, 
+        int* count) {
+    GameStateInfo* state = &game->state;
+    TileShape* shape = get_tile_shape(state->tiles, state->tileIndex);
+    int inst[INST_MAX];
+    *count = 0;
+    // angles past the distinct rotations repeat earlier ones
+    for (inst[ROTATE] = 0; inst[ROTATE] < shape->distinct * ROTATE_90; 
+            inst[ROTATE] += ROTATE_90) {
+        char** tile = get_rotated_tile(state->tiles, state->tileIndex, 
+                inst[ROTATE]);
+        for (inst[COLM] = MIN_MOVE; inst[COLM] < MAX_MOVE_C; inst[COLM]++) {
+            for (inst[ROW] = MIN_MOVE; inst[ROW] < MAX_MOVE_R; inst[ROW]++) {
+                if (is_move_ruled_out(state, inst) || 
+                        !is_move_valid(tile, state, inst)) {
+                    continue;
+                }
+                if (*count < max) {
+                    moves[*count].colm = inst[COLM];
+                    moves[*count].row = inst[ROW];
+                    moves[*count].rotate = inst[ROTATE];
+                }
+                (*count)++;
+            }
+        }
+    }
+    return *count > max ? FITZ_ERR_BUFFER : FITZ_OK;
+}
+
+int fitz_game_apply(FitzGame* game, FitzMove move) {
+    GameStateInfo* state = &game->state;
+    if (is_game_over(state)) {
+        return FITZ_ERR_GAME_OVER;
+    } else if (move.colm < MIN_MOVE || move.colm > MAX_MOVE_C || 
+            move.row < MIN_MOVE || move.row > MAX_MOVE_R || 
+            move.rotate < 0 || move.rotate > ROTATE_270 || 
+            move.rotate % ROTATE_90 != 0) {
+        return FITZ_ERR_MOVE;
+    }
+    int inst[INST_MAX] = {move.colm, move.row, move.rotate};
+    if (!is_move_valid(get_rotated_tile(state->tiles, state->tileIndex, 
+            move.rotate), state, inst)) {
+        return FITZ_ERR_MOVE;
+    }
+    state->player = turn_player(state);
+    state->inst[COLM] = move.colm;
+    state->inst[ROW] = move.row;
+    state->inst[ROTATE] = move.rotate;
+    push_move(game);
+    return FITZ_OK;
+}
+
+int fitz_game_step(FitzGame* game, FitzMove* played) {
+    GameStateInfo* state = &game->state;
+    char type = state->turn == P1 ? state->p1Type : state->p2Type;
+    if (is_game_over(state)) {
+        return FITZ_ERR_GAME_OVER;
+    } else if (!is_auto_player(type)) {
+        return FITZ_ERR_NOT_AUTO;
+    }
+    state->player = turn_player(state);
+    process_ap(state);
+    if (played != NULL) {
+        played->colm = state->inst[COLM];
+        played->row = state->inst[ROW];
+        played->rotate = state->inst[ROTATE];
+    }
+    push_move(game);
+    return FITZ_OK;
+}
+
+int fitz_game_undo(FitzGame* game) {
+    if (game->undoCount == 0) {
+        return FITZ_ERR_NO_UNDO;
+    }
+    unmake_move(&game->state, &game->undos[--game->undoCount]);
+    return FITZ_OK;
+}
+
+void fitz_game_free(FitzGame* game) {
+    end_game(&game->state);
+    mem_free(MEM_LIBRARY, game->undos);
+    mem_free(MEM_LIBRARY, game);
+}
+
+const char* fitz_strerror(int status) {
+    switch (status) {
+        case FITZ_OK:
+            return "Success";
+        case FITZ_ERR_ACCESS:
+            return "Can't access tile file";
+        case FITZ_ERR_TILES:
+            return "Invalid tile file contents";
+        case FITZ_ERR_PLAYER:
+            return "Invalid player type";
+        case FITZ_ERR_DIMENSIONS:
+            return "Invalid dimensions";
+        case FITZ_ERR_SAVE:
+            return "Invalid save file contents";
+        case FITZ_ERR_MOVE:
+            return "Invalid move";
+        case FITZ_ERR_GAME_OVER:
+            return "Game is over";
+        case FITZ_ERR_NOT_AUTO:
+            return "Current player is not an automatic player";
+        case FITZ_ERR_BUFFER:
+            return "Buffer too small";
+        case FITZ_ERR_NO_UNDO:
+            return "No move to undo";
+        default:
+            return "Unknown error";
+    }
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int read_tiles(FILE* file, FitzTiles** tiles) {
+    FitzTiles* newTiles = mem_malloc(MEM_LIBRARY, sizeof(FitzTiles));
+    newTiles->loaded.tilefileName = NULL;
+    bool valid = read_tilefile(&newTiles->loaded, file);
+    fclose(file);
+    if (!valid) {
+        mem_free(MEM_LIBRARY, newTiles);
+        return FITZ_ERR_TILES;
+    }
+    *tiles = newTiles;
+    return FITZ_OK;
+}
+
+//
+static bool is_type_valid(char type) {
+    return type == FITZ_HUMAN || is_auto_player(type);
+}
+
+//
+static char turn_player(GameStateInfo* state) {
+    return state->turn == P1 ? PLAYER_1 : PLAYER_2;
+}
+
+//
+static void push_move(FitzGame* game) {
+    if (game->undoCount == game->undoSize) {
+        game->undoSize = game->undoSize == 0 ? UNDO_START : 2 * game->undoSize;
+        game->undos = mem_realloc(MEM_LIBRARY, game->undos,
+                sizeof(MoveUndo) * game->undoSize);
+    }
+    make_move(&game->state, &game->undos[game->undoCount++]);
+}
+
+//
+static void init_undos(FitzGame* game) {
+    game->undos = NULL;
+    game->undoCount = 0;
+    game->undoSize = 0;
+}
@@ -15,6 +15,13 @@
 #include "saveGame.h"
 #include "humanPlayer.h"
 #include "autoPlayer.h"
+#include "generator.h"
+#include "selfplay.h"
+#include "analyze.h"
+#include "server.h"
+#include "searchPlayer.h"
+#include "book.h"
+#include "options.h"
 
 #define DISPLAY_TILEFILE 2
 #define ARGV_TILEFILE 1
@@ -23,7 +30,6 @@
 #define ARGV_HEIGHT 4
 #define ARGV_WIDTH 5
 #define ARGV_SAVE_FILE 4
-#define MAX_BOARD_SIZE 999
 #define PLAYER_TYPE_LEN 1
 #define PLAYER_TYPE_INDEX 0
 
@@ -51,7 +57,7 @@ static void assign_dimensions(char* height, char* width, GameStateInfo* state);
  *
  * state: The current state of the game
  *
- * error_4: The player types must equal either ('h' || '1' || '2')
+ * error_4: The player types must equal either ('h' || '1' to '6')
  */
 static void assign_player_type(char* p1, char* p2, GameStateInfo* state);
 
@@ -60,10 +66,31 @@ static void assign_player_type(char* p1, char* p2, GameStateInfo* state);
 int main(int argc, char** argv) {
     GameStateInfo state;
     LoadedTilefile loadedFile;
+    // search and measuring options come first, in any order, and apply to
+    // every mode
+    int skipped;
+    do {
+        skipped = parse_search_options(argc, argv);
+        skipped += parse_instrument_options(argc - skipped, argv + skipped);
+        argc -= skipped;
+        argv += skipped;
+    } while (skipped > 0);
+    if (argc > 1 && (strcmp(argv[1], GEN_TILES) == 0 || 
+            strcmp(argv[1], GEN_SAVE) == 0)) {
+        return generator_main(argc, argv);
+    } else if (argc > 1 && strcmp(argv[1], SELFPLAY) == 0) {
+        return selfplay_main(argc, argv);
+    } else if (argc > 1 && strcmp(argv[1], ANALYZE) == 0) {
+        return analyze_main(argc, argv);
+    } else if (argc > 1 && strcmp(argv[1], SERVE) == 0) {
+        return server_main(argc, argv);
+    } else if (argc > 1 && strcmp(argv[1], BUILD_BOOK) == 0) {
+        return build_book_main(argc, argv);
+    }
     switch (argc) {
         case NEW_GAME:            
             loadedFile.tilefileName = argv[ARGV_TILEFILE];
-            load_tilefile(&loadedFile);
+            load_tile_source(&loadedFile);
             assign_player_type(argv[ARGV_P1_TYPE], argv[ARGV_P2_TYPE],
                     &state);
             assign_dimensions(argv[ARGV_HEIGHT], argv[ARGV_WIDTH], &state);
@@ -72,11 +99,10 @@ int main(int argc, char** argv) {
 
         case LOAD_GAME:
             loadedFile.tilefileName = argv[ARGV_TILEFILE];
-            load_tilefile(&loadedFile);
+            load_tile_source(&loadedFile);
             assign_player_type(argv[ARGV_P1_TYPE], argv[ARGV_P2_TYPE], 
                     &state);
             load_game(argv[ARGV_SAVE_FILE], &state, &loadedFile);
-            loadedFile.index = state.tileIndex;
             // assigns players name
             if (state.turn == P1) {
                 state.player = PLAYER_1;
@@ -88,7 +114,7 @@ int main(int argc, char** argv) {
 
         case DISPLAY_TILEFILE:
             loadedFile.tilefileName = argv[ARGV_TILEFILE];
-            load_tilefile(&loadedFile);
+            load_tile_source(&loadedFile);
             display_tilefile(&loadedFile);
             break;
 
@@ -117,9 +143,8 @@ static void assign_dimensions(char* height, char* width,
 static void assign_player_type(char* p1, char* p2, GameStateInfo* state) {
     state->p1Type = p1[PLAYER_TYPE_INDEX];
     state->p2Type = p2[PLAYER_TYPE_INDEX];
-    if ((state->p1Type != HUMAN && state->p1Type != APT1 &&
-            state->p1Type != APT2) || (state->p2Type != HUMAN && 
-            state->p2Type != APT1 && state->p2Type != APT2) || 
+    if ((state->p1Type != HUMAN && !is_auto_player(state->p1Type)) || 
+            (state->p2Type != HUMAN && !is_auto_player(state->p2Type)) || 
             (strlen(p1) != PLAYER_TYPE_LEN || strlen(p2) != PLAYER_TYPE_LEN)) {
         // player type is invalid
         error_4();
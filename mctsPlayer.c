@@ -0,0 +1,573 @@
+/*
+ * mctsPlayer.c
+ * Author: Michael Bossner
+ *
+ * This file contains the automatic player that chooses moves with Monte
+ * Carlo tree search. Everything a thread needs is allocated the first time
+ * the player moves and kept for the game, so that games only copy and fill
+ * cells. Each game keeps a list of its empty cells so that placements are
+ * only looked for over cells a tile can still cover.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "mctsPlayer.h"
+#include "searchPlayer.h"
+#include "searchBoard.h"
+#include "threadPool.h"
+#include "generator.h"
+#include "game.h"
+#include "memStats.h"
+
+#define NODE_BITS 18
+#define MAX_NODES (1 << NODE_BITS)
+#define UNEXPANDED -1
+#define EXPLORATION 1.4
+#define RANDOM_TRIES 8
+#define CLOCK_CHECK 32
+#define SEED_STEP 1000003UL
+#define MILLISECONDS 1e3
+#define NANOSECONDS 1e9
+
+typedef struct TreeNode TreeNode;
+typedef struct MctsThread MctsThread;
+
+/*
+ * A position in the tree of one thread
+ */
+struct TreeNode {
+    Placement move; // The move that leads here
+    int firstChild; // Index of the first child in the pool
+    int childCount; // Number of children or UNEXPANDED
+    unsigned int visits; // Random games played through the node
+    unsigned int wins; // Those won by the player who made the move
+};
+
+/*
+ * Everything one thread of the search uses
+ */
+struct MctsThread {
+    MctsTrees* trees; // The search the thread belongs to
+    SearchBoard board; // The board of the current random game
+    Random random; // Chooses the random moves
+    TreeNode* nodes; // Pool of tree nodes. The root is node 0
+    int nodeCount; // Nodes used from the pool
+    int nodeLimit; // Nodes the tree of this move may use
+    int* path; // Nodes visited by the current random game
+    Placement* moves; // Every placement of a tile when they are listed
+    int* empty; // Empty cells of the current random game in any order
+    int* slots; // Index in empty of each empty cell
+    int emptyCount; // Number of empty cells
+    int playouts; // Random games to be played
+    int played; // Random games played
+};
+
+/*
+ * Everything the player keeps for the game
+ */
+struct MctsTrees {
+    SearchBoard root; // The board at the root
+    int* empty; // Empty cells at the root
+    int* slots; // Index in empty of each empty cell at the root
+    int emptyCount; // Number of empty cells at the root
+    int rootTile; // Tile placed at the root
+    struct timespec start; // When the search started
+    MctsThread* threads; // The threads
+    int threadCount; // Number of threads
+    int nodeCapacity; // Nodes allocated in the pool of each thread
+};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Allocates everything the player keeps for the game.
+ *
+ * setup: The game
+ *
+ * threadCount: Number of threads searching
+ *
+ * return: Returns the new trees
+ */
+static MctsTrees* create_mcts_trees(SearchSetup* setup, int threadCount);
+
+/*
+ * Plays random games until a thread has played its share or the time is
+ * up. Run by the thread pool.
+ *
+ * index: Which MctsThread plays
+ *
+ * thread: The pool thread running it
+ *
+ * trees: The MctsTrees
+ */
+static void run_playouts(int index, int thread, void* trees);
+
+/*
+ * Sets the board and empty cells of a thread back to the root.
+ *
+ * thread: The thread
+ */
+static void restart_game(MctsThread* thread);
+
+/*
+ * Places a tile on the board of a thread and takes the cells it covers
+ * off the list of empty cells.
+ *
+ * thread: The thread playing
+ *
+ * tileIndex: The tile
+ *
+ * move: Where the tile is placed
+ */
+static void play_move(MctsThread* thread, int tileIndex, Placement* move);
+
+/*
+ * Plays one random game from the root and records its result in the tree.
+ *
+ * thread: The thread playing
+ */
+static void playout(MctsThread* thread);
+
+/*
+ * Adds a child for every placement of a tile to a node if there is room.
+ * The pool always has room for the children of the root.
+ *
+ * thread: The thread playing. Its board holds the position of the node
+ *
+ * node: Index of the node
+ *
+ * tileIndex: Tile placed at the node
+ */
+static void expand(MctsThread* thread, int node, int tileIndex);
+
+/*
+ * Chooses the child of a node with the best upper confidence bound.
+ *
+ * thread: The thread playing
+ *
+ * node: The node
+ *
+ * return: Returns the index of the child
+ */
+static int select_child(MctsThread* thread, TreeNode* node);
+
+/*
+ * Chooses a random placement of a tile. A few placements are tried at
+ * random before every placement is listed. Every placement is as likely.
+ *
+ * thread: The thread playing. Its board holds the position
+ *
+ * tileIndex: The tile
+ *
+ * move: Where the placement is returned
+ *
+ * return: Returns false if the tile cannot be placed
+ */
+static bool random_move(MctsThread* thread, int tileIndex, Placement* move);
+
+/*
+ * Lists every placement of a tile. Each rotation either tries every
+ * position on the board or anchors its first cell on every empty cell,
+ * whichever is fewer.
+ *
+ * thread: The thread playing. Its board holds the position
+ *
+ * tileIndex: The tile
+ *
+ * moves: Where the placements are returned
+ *
+ * return: Returns the number of placements
+ */
+static int list_moves(MctsThread* thread, int tileIndex, Placement* moves);
+
+/*
+ * Finds the placement of a rotation of a tile whose first cell is over a
+ * cell. Each placement has exactly one cell under its first cell, so
+ * trying each empty cell finds each placement once.
+ *
+ * setup: The game
+ *
+ * shape: Shape of the tile
+ *
+ * cells: Cells of the rotation
+ *
+ * cell: Index of the cell
+ *
+ * move: Holds the rotation. The position is returned in it
+ *
+ * return: Returns false if the placement is off the board
+ */
+static bool anchor_move(SearchSetup* setup, TileShape* shape,
+        RotationCells* cells, int cell, Placement* move);
+
+/*
+ * Gets how long a search has taken.
+ *
+ * trees: The search
+ *
+ * return: Returns the time since the search started in seconds
+ */
+static double elapsed(MctsTrees* trees);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+void mcts_move(GameStateInfo* state) {
+    SearchOptions* options = get_search_options();
+    int threadCount = search_thread_count();
+    Search* search = get_search(state, 1);
+    SearchSetup* setup = search->setup;
+    if (search->mcts == NULL) {
+        search->mcts = create_mcts_trees(setup, threadCount);
+    }
+    if (search->pool == NULL) {
+        search->pool = create_thread_pool(threadCount);
+    }
+    MctsTrees* trees = search->mcts;
+    clock_gettime(CLOCK_MONOTONIC, &trees->start);
+    load_search_board(&trees->root, state);
+    trees->rootTile = state->tileIndex;
+    trees->emptyCount = 0;
+    for (int cell = 0; cell < setup->height * setup->width; cell++) {
+        if (!trees->root.cells[cell]) {
+            trees->slots[cell] = trees->emptyCount;
+            trees->empty[trees->emptyCount++] = cell;
+        }
+    }
+    for (int i = 0; i < threadCount; i++) {
+        MctsThread* thread = &trees->threads[i];
+        // every thread and move gets its own random games
+        seed_random(&thread->random, options->mctsSeed * SEED_STEP +
+                (unsigned long)state->moveCount * MAX_THREADS + i);
+        restart_game(thread);
+        // a big board can have more root moves than MAX_NODES
+        thread->nodeLimit = 1 + list_moves(thread, trees->rootTile,
+                thread->moves);
+        if (thread->nodeLimit < MAX_NODES) {
+            thread->nodeLimit = MAX_NODES;
+        }
+        thread->playouts = options->playouts / threadCount +
+                (i < options->playouts % threadCount);
+        thread->played = 0;
+        // every tree starts with the same root moves
+        thread->nodes[0].childCount = UNEXPANDED;
+        thread->nodes[0].visits = 0;
+        thread->nodeCount = 1;
+        expand(thread, 0, trees->rootTile);
+    }
+
+    run_pool_jobs(search->pool, threadCount, run_playouts, trees);
+
+    // merge the root of every tree. The trees share their root moves
+    TreeNode* root = &trees->threads[0].nodes[0];
+    int rootMoves = root->childCount == UNEXPANDED ? 0 : root->childCount;
+    int best = 0;
+    unsigned long bestVisits = 0;
+    unsigned long bestWins = 0;
+    unsigned long played = 0;
+    for (int i = 0; i < threadCount; i++) {
+        played += trees->threads[i].played;
+    }
+    for (int child = 0; child < rootMoves; child++) {
+        unsigned long visits = 0;
+        unsigned long wins = 0;
+        for (int i = 0; i < threadCount; i++) {
+            TreeNode* node = &trees->threads[i].nodes[root->firstChild +
+                    child];
+            visits += node->visits;
+            wins += node->wins;
+        }
+        if (child == 0 || visits > bestVisits ||
+                (visits == bestVisits && wins > bestWins)) {
+            best = child;
+            bestVisits = visits;
+            bestWins = wins;
+        }
+    }
+    if (rootMoves > 0) {
+        placement_to_inst(setup, trees->rootTile,
+                &trees->threads[0].nodes[root->firstChild + best].move,
+                state->inst);
+    }
+    if (options->stats) {
+        double seconds = elapsed(trees);
+        fprintf(stderr, "Player %c mcts: threads %d, playouts %lu, "
+                "%.0f playouts/s, best move won %.1f%% of %lu\n",
+                state->player, threadCount, played,
+                seconds > 0 ? played / seconds : 0.0,
+                bestVisits ? 100.0 * bestWins / bestVisits : 0.0, bestVisits);
+    }
+}
+
+void free_mcts_trees(MctsTrees* trees) {
+    for (int i = 0; i < trees->threadCount; i++) {
+        free_search_board(&trees->threads[i].board);
+        mem_free(MEM_AUTO_PLAYER, trees->threads[i].nodes);
+        mem_free(MEM_AUTO_PLAYER, trees->threads[i].path);
+        mem_free(MEM_AUTO_PLAYER, trees->threads[i].moves);
+        mem_free(MEM_AUTO_PLAYER, trees->threads[i].empty);
+        mem_free(MEM_AUTO_PLAYER, trees->threads[i].slots);
+    }
+    mem_free(MEM_AUTO_PLAYER, trees->threads);
+    mem_free(MEM_AUTO_PLAYER, trees->empty);
+    mem_free(MEM_AUTO_PLAYER, trees->slots);
+    free_search_board(&trees->root);
+    mem_free(MEM_AUTO_PLAYER, trees);
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static MctsTrees* create_mcts_trees(SearchSetup* setup, int threadCount) {
+    MctsTrees* trees = mem_malloc(MEM_AUTO_PLAYER, sizeof(MctsTrees));
+    int cellCount = setup->height * setup->width;
+    init_search_board(&trees->root, setup);
+    trees->empty = mem_malloc(MEM_AUTO_PLAYER, sizeof(int) * cellCount);
+    trees->slots = mem_malloc(MEM_AUTO_PLAYER, sizeof(int) * cellCount);
+    trees->threads = mem_malloc(MEM_AUTO_PLAYER,
+            sizeof(MctsThread) * threadCount);
+    trees->threadCount = threadCount;
+    // room for every root move however many there are
+    trees->nodeCapacity = 1 + ROTATIONS * cellCount;
+    if (trees->nodeCapacity < MAX_NODES) {
+        trees->nodeCapacity = MAX_NODES;
+    }
+    for (int i = 0; i < threadCount; i++) {
+        MctsThread* thread = &trees->threads[i];
+        thread->trees = trees;
+        init_search_board(&thread->board, setup);
+        thread->nodes = mem_malloc(MEM_AUTO_PLAYER,
+                sizeof(TreeNode) * trees->nodeCapacity);
+        thread->path = mem_malloc(MEM_AUTO_PLAYER,
+                sizeof(int) * (cellCount + 1));
+        thread->moves = mem_malloc(MEM_AUTO_PLAYER,
+                sizeof(Placement) * ROTATIONS * cellCount);
+        thread->empty = mem_malloc(MEM_AUTO_PLAYER, sizeof(int) * cellCount);
+        thread->slots = mem_malloc(MEM_AUTO_PLAYER, sizeof(int) * cellCount);
+    }
+    return trees;
+}
+
+//
+static void run_playouts(int index, int thread, void* trees) {
+    MctsThread* mcts = &((MctsTrees*)trees)->threads[index];
+    int limit = get_search_options()->mctsTime;
+    // games need a root with moves and a single move needs none
+    int rootMoves = mcts->nodes[0].childCount;
+    if (rootMoves == UNEXPANDED || rootMoves <= 1) {
+        return;
+    }
+    while (mcts->played < mcts->playouts) {
+        if (limit > 0 && mcts->played % CLOCK_CHECK == 0 &&
+                elapsed(mcts->trees) * MILLISECONDS >= limit) {
+            break;
+        }
+        playout(mcts);
+        mcts->played++;
+    }
+}
+
+//
+static void restart_game(MctsThread* thread) {
+    MctsTrees* trees = thread->trees;
+    copy_search_board(&thread->board, &trees->root);
+    thread->emptyCount = trees->emptyCount;
+    memcpy(thread->empty, trees->empty, sizeof(int) * trees->emptyCount);
+    memcpy(thread->slots, trees->slots,
+            sizeof(int) * trees->root.setup->height * trees->root.setup->width);
+}
+
+//
+static void play_move(MctsThread* thread, int tileIndex, Placement* move) {
+    SearchSetup* setup = thread->board.setup;
+    set_placement(&thread->board, tileIndex, move, 1);
+    RotationCells* cells = get_rotation_cells(setup, tileIndex,
+            move->rotation);
+    int count = get_tile_shape(setup->tiles, tileIndex)->cellCount;
+    int base = move->colm * setup->width + move->row;
+    for (int i = 0; i < count; i++) {
+        // the last empty cell takes the place of the one filled
+        int slot = thread->slots[base + cells->offsets[i]];
+        int last = thread->empty[--thread->emptyCount];
+        thread->empty[slot] = last;
+        thread->slots[last] = slot;
+    }
+}
+
+//
+static void playout(MctsThread* thread) {
+    LoadedTilefile* tiles = thread->board.setup->tiles;
+    restart_game(thread);
+    int tileIndex = thread->trees->rootTile;
+    int node = 0;
+    int depth = 0;
+    thread->path[depth++] = node;
+    // follow the tree down to a node not yet expanded
+    while (thread->nodes[node].childCount > 0) {
+        node = select_child(thread, &thread->nodes[node]);
+        play_move(thread, tileIndex, &thread->nodes[node].move);
+        tileIndex = next_tile(tiles, tileIndex);
+        thread->path[depth++] = node;
+    }
+    if (thread->nodes[node].childCount == UNEXPANDED) {
+        expand(thread, node, tileIndex);
+        TreeNode* leaf = &thread->nodes[node];
+        if (leaf->childCount > 0) {
+            node = leaf->firstChild + next_random(&thread->random) %
+                    leaf->childCount;
+            play_move(thread, tileIndex, &thread->nodes[node].move);
+            tileIndex = next_tile(tiles, tileIndex);
+            thread->path[depth++] = node;
+        }
+    }
+    // play randomly until a player cannot place their tile
+    int moves = 0;
+    Placement move;
+    while (random_move(thread, tileIndex, &move)) {
+        play_move(thread, tileIndex, &move);
+        tileIndex = next_tile(tiles, tileIndex);
+        moves++;
+    }
+    // the player to move at the end lost. Node i was moved to by the player
+    // who moves at ply i - 1
+    int loserPly = depth - 1 + moves;
+    for (int i = 0; i < depth; i++) {
+        TreeNode* visited = &thread->nodes[thread->path[i]];
+        visited->visits++;
+        if (i > 0 && (loserPly - (i - 1)) % 2 == 1) {
+            visited->wins++;
+        }
+    }
+}
+
+//
+static void expand(MctsThread* thread, int node, int tileIndex) {
+    int count = list_moves(thread, tileIndex, thread->moves);
+    if (thread->nodeCount + count > thread->nodeLimit) {
+        // the pool is full so games from here are only random
+        return;
+    }
+    TreeNode* parent = &thread->nodes[node];
+    parent->firstChild = thread->nodeCount;
+    parent->childCount = count;
+    for (int i = 0; i < count; i++) {
+        TreeNode* child = &thread->nodes[thread->nodeCount++];
+        child->move = thread->moves[i];
+        child->firstChild = 0;
+        child->childCount = UNEXPANDED;
+        child->visits = 0;
+        child->wins = 0;
+    }
+}
+
+//
+static int select_child(MctsThread* thread, TreeNode* node) {
+    double logVisits = log(node->visits + 1);
+    int best = node->firstChild;
+    double bestValue = -1;
+    for (int i = node->firstChild; i < node->firstChild + node->childCount;
+            i++) {
+        TreeNode* child = &thread->nodes[i];
+        // children never visited are tried first
+        if (child->visits == 0) {
+            return i;
+        }
+        double value = (double)child->wins / child->visits +
+                EXPLORATION * sqrt(logVisits / child->visits);
+        if (value > bestValue) {
+            bestValue = value;
+            best = i;
+        }
+    }
+    return best;
+}
+
+//
+static bool random_move(MctsThread* thread, int tileIndex, Placement* move) {
+    SearchSetup* setup = thread->board.setup;
+    TileShape* shape = get_tile_shape(setup->tiles, tileIndex);
+    if (thread->emptyCount < shape->cellCount) {
+        return false;
+    }
+    for (int i = 0; i < RANDOM_TRIES; i++) {
+        move->rotation = next_random(&thread->random) % shape->distinct;
+        RotationCells* cells = get_rotation_cells(setup, tileIndex,
+                move->rotation);
+        int cell = thread->empty[next_random(&thread->random) %
+                thread->emptyCount];
+        if (anchor_move(setup, shape, cells, cell, move) &&
+                fits_at(&thread->board, cells, shape->cellCount,
+                move->colm * setup->width + move->row)) {
+            return true;
+        }
+    }
+    // the board is too full to find a placement by chance
+    int count = list_moves(thread, tileIndex, thread->moves);
+    if (count == 0) {
+        return false;
+    }
+    *move = thread->moves[next_random(&thread->random) % count];
+    return true;
+}
+
+//
+static int list_moves(MctsThread* thread, int tileIndex, Placement* moves) {
+    SearchSetup* setup = thread->board.setup;
+    TileShape* shape = get_tile_shape(setup->tiles, tileIndex);
+    int count = 0;
+    Placement move;
+    move.score = 0;
+    for (move.rotation = 0; move.rotation < shape->distinct;
+            move.rotation++) {
+        RotationCells* cells = get_rotation_cells(setup, tileIndex,
+                move.rotation);
+        int positions = (setup->height - cells->maxY + cells->minY) *
+                (setup->width - cells->maxX + cells->minX);
+        if (positions > thread->emptyCount) {
+            for (int i = 0; i < thread->emptyCount; i++) {
+                if (anchor_move(setup, shape, cells, thread->empty[i],
+                        &move) && fits_at(&thread->board, cells,
+                        shape->cellCount,
+                        move.colm * setup->width + move.row)) {
+                    moves[count++] = move;
+                }
+            }
+            continue;
+        }
+        // a mostly empty board has fewer positions than empty cells
+        for (move.colm = -cells->minY;
+                move.colm < setup->height - cells->maxY; move.colm++) {
+            for (move.row = -cells->minX;
+                    move.row < setup->width - cells->maxX; move.row++) {
+                if (fits_at(&thread->board, cells, shape->cellCount,
+                        move.colm * setup->width + move.row)) {
+                    moves[count++] = move;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+//
+static bool anchor_move(SearchSetup* setup, TileShape* shape,
+        RotationCells* cells, int cell, Placement* move) {
+    move->colm = cell / setup->width - shape->cellY[move->rotation][0];
+    move->row = cell % setup->width - shape->cellX[move->rotation][0];
+    return move->colm >= -cells->minY &&
+            move->colm < setup->height - cells->maxY &&
+            move->row >= -cells->minX && move->row < setup->width - cells->maxX;
+}
+
+//
+static double elapsed(MctsTrees* trees) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - trees->start.tv_sec) +
+            (now.tv_nsec - trees->start.tv_nsec) / NANOSECONDS;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+/*
+ * mctsPlayer.h
+ * Author: Michael Bossner
+ *
+ * Header file for mctsPlayer.c
+ */
+
+#ifndef MCTS_PLAYER_H
+#define MCTS_PLAYER_H
+
+#include "game.h"
+
+#define APT5 '5'
+
+typedef struct MctsTrees MctsTrees;
+
+/*
+ * Chooses a move for the current player with Monte Carlo tree search. Each
+ * of --search-threads threads grows its own tree from --playouts random
+ * games shared between them, and the move visited most across every tree is
+ * played. The trees, their buffers and the threads are kept for the game.
+ * A thread stops early once --mcts-time milliseconds have passed.
+ * With no time limit reached the move only depends on the position, the
+ * options and the number of threads.
+ * Updates state->inst with the move chosen.
+ *
+ * state: The current state of the game. There must be a valid move
+ */
+void mcts_move(GameStateInfo* state);
+
+/*
+ * Frees the trees and buffers kept by the Monte Carlo player.
+ *
+ * trees: The trees
+ */
+void free_mcts_trees(MctsTrees* trees);
+
+#endif
\ No newline at end of file
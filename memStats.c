@@ -0,0 +1,208 @@
+/*
+ * memStats.c
+ * Author: Michael Bossner
+ *
+ * This file contains the allocation counts turned on by --memstats. The
+ * subsystems allocate through mem_malloc and friends, which are plain
+ * malloc and friends while the counts are off. The size of each block is
+ * read back from the allocator so nothing has to be stored next to it.
+ * Turns are counted on their own thread so games played side by side by
+ * --selfplay each have their own turns.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <malloc.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "memStats.h"
+#include "error.h"
+
+typedef struct SubsystemStats SubsystemStats;
+
+/*
+ * What one subsystem has allocated
+ */
+struct SubsystemStats {
+    uint64_t allocations; // Blocks allocated or resized
+    uint64_t bytes; // Bytes of every block allocated or resized to
+    int64_t live; // Bytes allocated and not yet freed
+};
+
+// Whether allocations are counted
+static bool enabled = false;
+// Most allocations a turn can make
+static unsigned long allocBudget = NO_BUDGET;
+// Each subsystem in the order of the MEM_ defines
+static SubsystemStats subsystems[MEM_SUBSYSTEMS];
+// Bytes allocated and not yet freed by every subsystem
+static int64_t liveBytes = 0;
+// Most bytes that were allocated at once
+static int64_t peakBytes = 0;
+// Turns ended
+static uint64_t turns = 0;
+// Allocations made during turns
+static uint64_t turnAllocations = 0;
+// Most allocations made by one turn
+static uint64_t maxTurnAllocations = 0;
+// Allocations made by the calling thread
+static __thread uint64_t threadAllocations = 0;
+// threadAllocations when the turn of the calling thread started
+static __thread uint64_t turnStart = 0;
+// JSON name of each subsystem
+static const char* subsystemNames[MEM_SUBSYSTEMS] = {"tilefile", "board",
+        "parser", "save", "auto_player", "server", "library", "batch"};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Adds an allocation to the counts.
+ *
+ * subsystem: Who the memory is for
+ *
+ * added: Bytes added to the live bytes. Negative when a block shrinks
+ *
+ * size: Bytes of the block allocated
+ */
+static void count_alloc(int subsystem, int64_t added, size_t size);
+
+/*
+ * Raises a count to a value if it is lower. Safe to call from any thread.
+ *
+ * max: The count
+ *
+ * value: The value
+ */
+static void raise_max(uint64_t* max, uint64_t value);
+
+/*
+ * Prints the counts to stderr as JSON. Registered with atexit.
+ */
+static void print_memstats(void);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+void enable_memstats(void) {
+    if (!enabled) {
+        enabled = true;
+        atexit(print_memstats);
+    }
+}
+
+void set_alloc_budget(unsigned long budget) {
+    enable_memstats();
+    allocBudget = budget;
+}
+
+void* mem_malloc(int subsystem, size_t size) {
+    void* pointer = malloc(size);
+    if (enabled && pointer != NULL) {
+        size_t usable = malloc_usable_size(pointer);
+        count_alloc(subsystem, usable, usable);
+    }
+    return pointer;
+}
+
+void* mem_calloc(int subsystem, size_t count, size_t size) {
+    void* pointer = calloc(count, size);
+    if (enabled && pointer != NULL) {
+        size_t usable = malloc_usable_size(pointer);
+        count_alloc(subsystem, usable, usable);
+    }
+    return pointer;
+}
+
+void* mem_realloc(int subsystem, void* pointer, size_t size) {
+    if (!enabled) {
+        return realloc(pointer, size);
+    }
+    int64_t before = pointer == NULL ? 0 : malloc_usable_size(pointer);
+    void* resized = realloc(pointer, size);
+    if (resized != NULL) {
+        size_t usable = malloc_usable_size(resized);
+        count_alloc(subsystem, (int64_t)usable - before, usable);
+    }
+    return resized;
+}
+
+void mem_free(int subsystem, void* pointer) {
+    if (enabled && pointer != NULL) {
+        int64_t usable = malloc_usable_size(pointer);
+        __atomic_fetch_sub(&subsystems[subsystem].live, usable,
+                __ATOMIC_RELAXED);
+        __atomic_fetch_sub(&liveBytes, usable, __ATOMIC_RELAXED);
+    }
+    free(pointer);
+}
+
+void start_mem_turn(void) {
+    turnStart = threadAllocations;
+}
+
+void end_mem_turn(bool warmup) {
+    if (!enabled) {
+        return;
+    }
+    uint64_t made = threadAllocations - turnStart;
+    __atomic_fetch_add(&turns, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&turnAllocations, made, __ATOMIC_RELAXED);
+    raise_max(&maxTurnAllocations, made);
+    if (!warmup && made > allocBudget) {
+        fprintf(stderr, "A turn made %llu allocations with a budget of %lu\n",
+                (unsigned long long)made, allocBudget);
+        error_11();
+    }
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void count_alloc(int subsystem, int64_t added, size_t size) {
+    SubsystemStats* stats = &subsystems[subsystem];
+    threadAllocations++;
+    __atomic_fetch_add(&stats->allocations, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->bytes, size, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->live, added, __ATOMIC_RELAXED);
+    int64_t live = __atomic_add_fetch(&liveBytes, added, __ATOMIC_RELAXED);
+    if (live > 0) {
+        raise_max((uint64_t*)&peakBytes, live);
+    }
+}
+
+//
+static void raise_max(uint64_t* max, uint64_t value) {
+    uint64_t seen = __atomic_load_n(max, __ATOMIC_RELAXED);
+    while (value > seen && !__atomic_compare_exchange_n(max, &seen, value,
+            false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // seen now holds the value another thread stored
+    }
+}
+
+//
+static void print_memstats(void) {
+    fprintf(stderr, "{\"subsystems\": {");
+    uint64_t allocations = 0;
+    for (int i = 0; i < MEM_SUBSYSTEMS; i++) {
+        SubsystemStats* stats = &subsystems[i];
+        allocations += stats->allocations;
+        fprintf(stderr, "%s\n  \"%s\": {\"allocations\": %llu, \"bytes\": "
+                "%llu, \"live_bytes\": %lld}", i == 0 ? "" : ",",
+                subsystemNames[i], (unsigned long long)stats->allocations,
+                (unsigned long long)stats->bytes, (long long)stats->live);
+    }
+    struct rusage usage;
+    long peakRss = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+    fprintf(stderr, "\n}, \"allocations\": %llu, \"live_bytes\": %lld, "
+            "\"peak_live_bytes\": %lld, \"turns\": %llu, "
+            "\"allocations_per_turn\": %.2f, \"max_turn_allocations\": %llu, "
+            "\"peak_rss_kb\": %ld}\n", (unsigned long long)allocations,
+            (long long)liveBytes, (long long)peakBytes,
+            (unsigned long long)turns,
+            turns == 0 ? 0.0 : (double)turnAllocations / turns,
+            (unsigned long long)maxTurnAllocations, peakRss);
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*
+ * memStats.h
+ * Author: Michael Bossner
+ *
+ * Header file for memStats.c
+ */
+
+#ifndef MEM_STATS_H
+#define MEM_STATS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#define MEM_TILEFILE 0
+#define MEM_BOARD 1
+#define MEM_PARSER 2
+#define MEM_SAVE 3
+#define MEM_AUTO_PLAYER 4
+#define MEM_SERVER 5
+#define MEM_LIBRARY 6
+#define MEM_BATCH 7
+#define MEM_SUBSYSTEMS 8
+#define NO_BUDGET ULONG_MAX
+
+/*
+ * Turns on the counting of allocations for the rest of the program. What
+ * each subsystem allocated, the allocations per turn and the peak resident
+ * size are printed to stderr as JSON when the program exits.
+ */
+void enable_memstats(void);
+
+/*
+ * Turns on the counting of allocations and ends the program when a turn
+ * allocates more than a budget.
+ *
+ * budget: Most allocations a turn can make. NO_BUDGET for any
+ */
+void set_alloc_budget(unsigned long budget);
+
+/*
+ * Allocates memory for a subsystem. The same as malloc.
+ *
+ * subsystem: Who the memory is for. One of the MEM_ defines
+ *
+ * size: Number of bytes
+ *
+ * return: Returns the memory
+ */
+void* mem_malloc(int subsystem, size_t size);
+
+/*
+ * Allocates zeroed memory for a subsystem. The same as calloc.
+ *
+ * subsystem: Who the memory is for. One of the MEM_ defines
+ *
+ * count: Number of elements
+ *
+ * size: Bytes in each element
+ *
+ * return: Returns the memory
+ */
+void* mem_calloc(int subsystem, size_t count, size_t size);
+
+/*
+ * Resizes memory of a subsystem. The same as realloc.
+ *
+ * subsystem: Who the memory is for. One of the MEM_ defines
+ *
+ * pointer: The memory. May be NULL
+ *
+ * size: New number of bytes
+ *
+ * return: Returns the resized memory
+ */
+void* mem_realloc(int subsystem, void* pointer, size_t size);
+
+/*
+ * Frees memory of a subsystem. The same as free.
+ *
+ * subsystem: Who the memory was allocated for
+ *
+ * pointer: The memory. May be NULL
+ */
+void mem_free(int subsystem, void* pointer);
+
+/*
+ * Starts counting the allocations of a turn on the calling thread.
+ */
+void start_mem_turn(void);
+
+/*
+ * Ends the turn started on the calling thread by start_mem_turn.
+ *
+ * warmup: Whether the turn sets up what later turns reuse. Warm up turns
+ *         are counted but can go over the budget
+ *
+ * error_11: The turn made more allocations than the budget. Program ends.
+ */
+void end_mem_turn(bool warmup);
+
+#endif
\ No newline at end of file
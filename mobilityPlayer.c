@@ -0,0 +1,289 @@
+/*
+ * mobilityPlayer.c
+ * Author: Michael Bossner
+ *
+ * This file contains the automatic player that takes away as many of the
+ * opponent's placements as it can with each move. Every placement of every
+ * shape that fits is found on the player's first move and kept for the
+ * rest of the game. Filling a cell only takes away the placements that
+ * cover it, and a candidate move is scored the same way, so neither needs
+ * more than the cells around it.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "mobilityPlayer.h"
+#include "searchPlayer.h"
+#include "searchBoard.h"
+#include "tilefile.h"
+#include "game.h"
+#include "memStats.h"
+
+#define MILLISECONDS 1e3
+#define NANOSECONDS 1e9
+
+typedef struct ShapeFits ShapeFits;
+
+/*
+ * The placements of one shape that fit
+ */
+struct ShapeFits {
+    char* fits; // Whether each placement fits. Indexed by pack_move
+    int* cover; // How many of the placements that fit cover each cell
+    int total; // Number of placements that fit
+};
+
+/*
+ * Everything the mobility player keeps for a game
+ */
+struct MobilityMap {
+    SearchBoard board; // The board the placements were found on
+    ShapeFits* shapes; // The placements of each shape
+};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Creates the placements of every shape for the current board.
+ *
+ * setup: The game the board belongs to
+ *
+ * state: The current state of the game
+ *
+ * return: Returns the placements
+ */
+static MobilityMap* create_mobility_map(SearchSetup* setup,
+        GameStateInfo* state);
+
+/*
+ * Brings the placements up to date with the cells filled since they were
+ * last used.
+ *
+ * map: The placements
+ *
+ * state: The current state of the game
+ *
+ * return: Returns false if a cell was emptied and the placements must be
+ *         found again
+ */
+static bool update_map(MobilityMap* map, GameStateInfo* state);
+
+/*
+ * Takes away every placement of every shape that covers a cell.
+ *
+ * map: The placements
+ *
+ * cell: Index of the cell that has been filled
+ */
+static void fill_cell(MobilityMap* map, int cell);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+void mobility_move(GameStateInfo* state) {
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Search* search = get_search(state, 1);
+    SearchSetup* setup = search->setup;
+    if (search->mobility != NULL && !update_map(search->mobility, state)) {
+        free_mobility_map(search->mobility);
+        search->mobility = NULL;
+    }
+    if (search->mobility == NULL) {
+        search->mobility = create_mobility_map(setup, state);
+    }
+    MobilityMap* map = search->mobility;
+    LoadedTilefile* tiles = setup->tiles;
+    int mine = tiles->tileShape[state->tileIndex];
+    int theirs = tiles->tileShape[next_tile(tiles, state->tileIndex)];
+    TileShape* shape = &tiles->shapes[mine];
+    ShapeFits* myFits = &map->shapes[mine];
+    ShapeFits* theirFits = &map->shapes[theirs];
+    Overlap overlaps[ROTATIONS][MAX_OVERLAPS];
+    int counts[ROTATIONS];
+    // no move can do better so the search stops once one does this well
+    int most = find_overlaps(setup, mine, theirs, overlaps, counts);
+    // what is added to the pack_move of a move at rotation 0 to get the
+    // pack_move of each placement it overlaps
+    int rowCount = setup->width - 2 * MIN_MOVE;
+    int packedOverlaps[ROTATIONS][MAX_OVERLAPS];
+    for (int r = 0; r < shape->distinct; r++) {
+        for (int i = 0; i < counts[r]; i++) {
+            packedOverlaps[r][i] = (overlaps[r][i].y * rowCount +
+                    overlaps[r][i].x) * ROTATIONS + overlaps[r][i].rotation;
+        }
+    }
+
+    Placement move;
+    move.score = 0;
+    Placement best = move;
+    int bestRemoved = -1;
+    int scored = 0;
+    for (move.colm = MIN_MOVE; move.colm < setup->height - MIN_MOVE &&
+            bestRemoved < most; move.colm++) {
+        for (move.row = MIN_MOVE; move.row < setup->width - MIN_MOVE &&
+                bestRemoved < most; move.row++) {
+            move.rotation = 0;
+            int packed = pack_move(setup, &move);
+            for (move.rotation = 0; move.rotation < shape->distinct &&
+                    bestRemoved < most; move.rotation++) {
+                if (!myFits->fits[packed + move.rotation]) {
+                    continue;
+                }
+                // a placement is counted once per cell it shares with the
+                // move so this is only an upper bound
+                int bound = 0;
+                for (int cell = 0; cell < shape->cellCount; cell++) {
+                    bound += theirFits->cover[(move.colm +
+                            shape->cellY[move.rotation][cell]) *
+                            setup->width + move.row +
+                            shape->cellX[move.rotation][cell]];
+                }
+                if (bound <= bestRemoved) {
+                    continue;
+                }
+                scored++;
+                int removed = 0;
+                int* overlap = packedOverlaps[move.rotation];
+                for (int i = 0; i < counts[move.rotation]; i++) {
+                    removed += theirFits->fits[packed + overlap[i]];
+                }
+                if (removed > bestRemoved) {
+                    bestRemoved = removed;
+                    best = move;
+                }
+            }
+        }
+    }
+    placement_to_inst(setup, state->tileIndex, &best, state->inst);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (get_search_options()->stats) {
+        fprintf(stderr, "Player %c mobility: scored %d of %d moves, "
+                "opponent left %d of %d placements, %.3f ms\n",
+                state->player, scored, myFits->total,
+                theirFits->total - bestRemoved, theirFits->total,
+                ((end.tv_sec - start.tv_sec) +
+                (end.tv_nsec - start.tv_nsec) / NANOSECONDS) * MILLISECONDS);
+    }
+}
+
+void free_mobility_map(MobilityMap* map) {
+    for (int shape = 0; shape < map->board.setup->tiles->shapeCount;
+            shape++) {
+        mem_free(MEM_AUTO_PLAYER, map->shapes[shape].fits);
+        mem_free(MEM_AUTO_PLAYER, map->shapes[shape].cover);
+    }
+    mem_free(MEM_AUTO_PLAYER, map->shapes);
+    free_search_board(&map->board);
+    mem_free(MEM_AUTO_PLAYER, map);
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static MobilityMap* create_mobility_map(SearchSetup* setup,
+        GameStateInfo* state) {
+    LoadedTilefile* tiles = setup->tiles;
+    MobilityMap* map = mem_malloc(MEM_AUTO_PLAYER, sizeof(MobilityMap));
+    init_search_board(&map->board, setup);
+    load_search_board(&map->board, state);
+    // the centre of a tile can be off the board
+    int placements = (setup->height - 2 * MIN_MOVE) *
+            (setup->width - 2 * MIN_MOVE) * ROTATIONS;
+    map->shapes = mem_malloc(MEM_AUTO_PLAYER,
+            sizeof(ShapeFits) * tiles->shapeCount);
+    for (int s = 0; s < tiles->shapeCount; s++) {
+        ShapeFits* shapeFits = &map->shapes[s];
+        TileShape* shape = &tiles->shapes[s];
+        shapeFits->fits = mem_calloc(MEM_AUTO_PLAYER, placements, sizeof(char));
+        shapeFits->cover = mem_calloc(MEM_AUTO_PLAYER,
+                setup->height * setup->width, sizeof(int));
+        shapeFits->total = 0;
+        Placement move;
+        for (move.rotation = 0; move.rotation < shape->distinct;
+                move.rotation++) {
+            RotationCells* cells = &setup->rotations[s * ROTATIONS +
+                    move.rotation];
+            for (move.colm = -cells->minY;
+                    move.colm < setup->height - cells->maxY; move.colm++) {
+                for (move.row = -cells->minX;
+                        move.row < setup->width - cells->maxX; move.row++) {
+                    int base = move.colm * setup->width + move.row;
+                    if (!fits_at(&map->board, cells, shape->cellCount,
+                            base)) {
+                        continue;
+                    }
+                    shapeFits->fits[pack_move(setup, &move)] = 1;
+                    shapeFits->total++;
+                    for (int cell = 0; cell < shape->cellCount; cell++) {
+                        shapeFits->cover[base + cells->offsets[cell]]++;
+                    }
+                }
+            }
+        }
+    }
+    return map;
+}
+
+//
+static bool update_map(MobilityMap* map, GameStateInfo* state) {
+    for (int colm = 0; colm < state->height; colm++) {
+        for (int row = 0; row < state->width; row++) {
+            int cell = colm * state->width + row;
+            char filled = state->board[colm][row] == PLAYER_1 ||
+                    state->board[colm][row] == PLAYER_2;
+            if (filled == map->board.cells[cell]) {
+                continue;
+            }
+            if (!filled) {
+                return false;
+            }
+            fill_cell(map, cell);
+            set_search_cell(&map->board, cell, 1);
+        }
+    }
+    return true;
+}
+
+//
+static void fill_cell(MobilityMap* map, int cell) {
+    SearchSetup* setup = map->board.setup;
+    int y = cell / setup->width;
+    int x = cell % setup->width;
+    for (int shape = 0; shape < setup->tiles->shapeCount; shape++) {
+        ShapeFits* shapeFits = &map->shapes[shape];
+        if (shapeFits->cover[cell] == 0) {
+            continue;
+        }
+        TileShape* tileShape = &setup->tiles->shapes[shape];
+        Placement move;
+        for (move.rotation = 0; move.rotation < tileShape->distinct;
+                move.rotation++) {
+            RotationCells* cells = &setup->rotations[shape * ROTATIONS +
+                    move.rotation];
+            // every placement with one of its cells on this cell
+            for (int i = 0; i < tileShape->cellCount; i++) {
+                move.colm = y - tileShape->cellY[move.rotation][i];
+                move.row = x - tileShape->cellX[move.rotation][i];
+                if (!on_board(setup, cells, move.colm, move.row)) {
+                    continue;
+                }
+                int placement = pack_move(setup, &move);
+                if (!shapeFits->fits[placement]) {
+                    continue;
+                }
+                shapeFits->fits[placement] = 0;
+                shapeFits->total--;
+                int base = move.colm * setup->width + move.row;
+                for (int j = 0; j < tileShape->cellCount; j++) {
+                    shapeFits->cover[base + cells->offsets[j]]--;
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+/*
+ * mobilityPlayer.h
+ * Author: Michael Bossner
+ *
+ * Header file for mobilityPlayer.c
+ */
+
+#ifndef MOBILITY_PLAYER_H
+#define MOBILITY_PLAYER_H
+
+#include "game.h"
+
+#define APT6 '6'
+
+typedef struct MobilityMap MobilityMap;
+
+/*
+ * Chooses the placement of the current tile that leaves the opponent the
+ * fewest placements for the next tile. The placements of every shape are
+ * kept for the whole game and only the ones around newly filled cells are
+ * looked at again each move. Ties go to the first placement found.
+ * Updates state->inst with the move chosen.
+ *
+ * state: The current state of the game. There must be a valid move
+ */
+void mobility_move(GameStateInfo* state);
+
+/*
+ * Frees the placements kept by the mobility player.
+ *
+ * map: The placements
+ */
+void free_mobility_map(MobilityMap* map);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,96 @@
+/*
+ * options.c
+ * Author: Michael Bossner
+ *
+ * This file contains functions for reading command line options and the
+ * options that turn on the measurements of the program.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "options.h"
+#include "error.h"
+#include "stats.h"
+#include "trace.h"
+#include "flightRecorder.h"
+#include "memStats.h"
+
+#define BASE_10 10
+#define INSTRUMENT_USAGE "fitz [--stats] [--perf] [--trace file] " \
+        "[--flight file] [--memstats] [--alloc-budget allocations] ..."
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+bool parse_int(char* arg, int* value) {
+    char* end;
+    errno = 0;
+    long number = strtol(arg, &end, BASE_10);
+    if (*arg == '\0' || *end != '\0' || errno || number < INT_MIN || 
+            number > INT_MAX) {
+        return false;
+    }
+    *value = (int)number;
+    return true;
+}
+
+bool parse_ulong(char* arg, unsigned long* value) {
+    char* end;
+    errno = 0;
+    // strtoul accepts a minus sign so it is checked for here
+    if (*arg == '\0' || *arg == '-') {
+        return false;
+    }
+    *value = strtoul(arg, &end, BASE_10);
+    return *end == '\0' && !errno;
+}
+
+bool parse_double(char* arg, double* value) {
+    char* end;
+    errno = 0;
+    *value = strtod(arg, &end);
+    return *arg != '\0' && *end == '\0' && !errno;
+}
+
+bool is_option(int argc, char** argv, int i, char* name) {
+    return strcmp(argv[i], name) == 0 && (i + 1) < argc;
+}
+
+int parse_instrument_options(int argc, char** argv) {
+    int arg = 1;
+    while (arg < argc) {
+        if (is_option(argc, argv, arg, "--trace")) {
+            if (!enable_trace(argv[arg + 1])) {
+                fprintf(stderr, "Can't write trace %s\n", argv[arg + 1]);
+                error_usage(INSTRUMENT_USAGE);
+            }
+            arg += 2;
+        } else if (is_option(argc, argv, arg, "--flight")) {
+            enable_flight_recorder(argv[arg + 1]);
+            arg += 2;
+        } else if (strcmp(argv[arg], "--stats") == 0) {
+            enable_stats();
+            arg++;
+        } else if (strcmp(argv[arg], "--perf") == 0) {
+            enable_perf_stats();
+            arg++;
+        } else if (strcmp(argv[arg], "--memstats") == 0) {
+            enable_memstats();
+            arg++;
+        } else if (is_option(argc, argv, arg, "--alloc-budget")) {
+            unsigned long budget;
+            // 0 allows a turn no allocations at all
+            if (!parse_ulong(argv[arg + 1], &budget)) {
+                error_usage(INSTRUMENT_USAGE);
+            }
+            set_alloc_budget(budget);
+            arg += 2;
+        } else {
+            break;
+        }
+    }
+    return arg - 1;
+}
@@ -0,0 +1,83 @@
+/*
+ * options.h
+ * Author: Michael Bossner
+ *
+ * Header file for options.c
+ */
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <stdbool.h>
+
+/*
+ * Converts a command line argument into an integer. The whole argument must
+ * be a decimal number.
+ *
+ * arg: The argument to be converted
+ *
+ * value: Where the converted integer is stored
+ *
+ * return: Returns true if the argument is a valid integer.
+ *         Returns false if the argument is not a valid integer.
+ */
+bool parse_int(char* arg, int* value);
+
+/*
+ * Converts a command line argument into an unsigned long.
+ *
+ * arg: The argument to be converted
+ *
+ * value: Where the converted number is stored
+ *
+ * return: Returns true if the argument is a valid number.
+ *         Returns false if the argument is not a valid number.
+ */
+bool parse_ulong(char* arg, unsigned long* value);
+
+/*
+ * Converts a command line argument into a decimal number.
+ *
+ * arg: The argument to be converted
+ *
+ * value: Where the converted number is stored
+ *
+ * return: Returns true if the argument is a valid number.
+ *         Returns false if the argument is not a valid number.
+ */
+bool parse_double(char* arg, double* value);
+
+/*
+ * Checks if a command line argument is a named option and that a value
+ * follows it.
+ *
+ * argc: Number of command line arguments
+ *
+ * argv: The command line arguments
+ *
+ * i: Index of the argument to be checked
+ *
+ * name: Name of the option including the leading "--"
+ *
+ * return: Returns true if argv[i] is the option and argv[i + 1] exists
+ */
+bool is_option(int argc, char** argv, int i, char* name);
+
+/*
+ * Reads the options that measure the program from the start of the command
+ * line arguments.
+ * fitz [--stats] [--perf] [--trace file] [--flight file] [--memstats]
+ *         [--alloc-budget allocations] ...
+ *
+ * argc: Number of command line arguments
+ *
+ * argv: The command line arguments
+ *
+ * return: Returns how many arguments were measuring options
+ *
+ * error_usage: A measuring option has an invalid value or the trace file
+ *         can't be created. Program ends.
+ */
+int parse_instrument_options(int argc, char** argv);
+
+#endif
@@ -0,0 +1,468 @@
+/*
+ * parallelSearch.c
+ * Author: Michael Bossner
+ *
+ * This file contains the automatic player that spreads its search over many
+ * threads. Each thread has a deque of jobs. A thread takes its newest job
+ * and when it has none steals the oldest job of another thread, sleeping
+ * while no thread has a job. Near the root a move is split into a job per
+ * reply and the young brothers wait: only the first reply is pushed at
+ * first, and once its score is known the other replies are pushed with a
+ * window that only asks whether they beat it. A reply that does is searched
+ * again for its exact score. The last job of a split to finish scores the
+ * split and reports to the split above it. The threads are kept in a
+ * ThreadPool for the game and each one runs its deque until the root is
+ * scored.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#include "parallelSearch.h"
+#include "searchPlayer.h"
+#include "searchBoard.h"
+#include "transTable.h"
+#include "threadPool.h"
+#include "game.h"
+#include "memStats.h"
+
+#define SHARED_TABLE_BITS 20
+#define SPLIT_PLIES 2
+#define MIN_SPLIT_DEPTH 2
+#define MAX_SPLITS SPLIT_PLIES
+#define MAX_JOBS (SPLIT_PLIES * MAX_BEAM)
+#define SECOND_NS 1000000000LL
+
+typedef struct Split Split;
+typedef struct Job Job;
+typedef struct JobDeque JobDeque;
+typedef struct ParallelRun ParallelRun;
+
+/*
+ * A position whose moves are searched as separate jobs
+ */
+struct Split {
+    Split* parent; // The split this position is a move of. NULL at the root
+    int parentMove; // Which move of the parent leads here
+    int tileIndex; // Tile placed by the player to move
+    int depth; // How many more moves are searched
+    int ply; // How many moves from the root the position is
+    int moveCount; // Number of moves searched
+    Placement moves[MAX_BEAM]; // The moves searched
+    int scores[MAX_BEAM]; // Score of each move for the player to move
+    int alpha; // Exact score of the first move once it is known
+    int pending; // Moves after the first whose score is not known yet
+};
+
+/*
+ * Searching one move of a split
+ */
+struct Job {
+    Split* split; // The split the move belongs to
+    int move; // Index of the move
+};
+
+/*
+ * The jobs of one thread. The owner works at the bottom and thieves take
+ * from the top.
+ */
+struct JobDeque {
+    pthread_mutex_t lock; // Protects top and bottom
+    Job jobs[MAX_JOBS]; // The jobs
+    int top; // Index of the oldest job
+    int bottom; // Index after the newest job
+};
+
+/*
+ * Everything shared by the threads of a search
+ */
+struct ParallelRun {
+    Search* search; // The search storage of the game
+    SearchBoard* root; // The board at the root
+    int threads; // Number of threads
+    JobDeque* deques; // One per thread
+    Split* splits; // Storage for every split
+    int splitCount; // Splits used so far
+    int best; // Index of the best root move once done
+    pthread_mutex_t lock; // Protects done and queued for sleeping threads
+    pthread_cond_t work; // Signalled when jobs are pushed or the root is done
+    int queued; // Jobs in every deque
+    int done; // Set once the root is scored
+};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Searches the root to one depth on every thread.
+ *
+ * run: The search. Its root board holds the position
+ *
+ * tileIndex: Index of the tile the player to move places
+ *
+ * depth: How many moves to search
+ *
+ * return: Returns the score of the best root move, which is left in
+ *         run->best
+ */
+static int search_depth(ParallelRun* run, int tileIndex, int depth);
+
+/*
+ * Runs and steals jobs until the root is scored. Run by each thread of the
+ * pool.
+ *
+ * id: Which thread this is. Its deque and worker have this index
+ *
+ * thread: The pool thread running it
+ *
+ * run: The ParallelRun
+ */
+static void run_thread(int id, int thread, void* run);
+
+/*
+ * Searches one move of a split. The first move is searched with a full
+ * window, splitting it again near the root. Any other move is first only
+ * checked against the score of the first.
+ *
+ * run: The search
+ *
+ * id: The thread running the job
+ *
+ * job: The job
+ */
+static void run_job(ParallelRun* run, int id, Job* job);
+
+/*
+ * Records the score of a move of a split. The score of the first move lets
+ * the other moves be pushed. Once every move of the split is scored the
+ * split is scored and reported to the split above it.
+ *
+ * run: The search
+ *
+ * id: The thread that scored the move
+ *
+ * split: The split
+ *
+ * move: Index of the move
+ *
+ * score: Score of the move for the player to move at the split
+ */
+static void finish_move(ParallelRun* run, int id, Split* split, int move,
+        int score);
+
+/*
+ * Plays the moves from the root down to a split onto a board.
+ *
+ * board: The board. Holds the root position
+ *
+ * split: The split
+ */
+static void play_path(SearchBoard* board, Split* split);
+
+/*
+ * Adds jobs for moves of a split to a deque and wakes sleeping threads.
+ * The lowest move is the one its owner takes first.
+ *
+ * run: The search
+ *
+ * deque: The deque of the thread pushing the jobs
+ *
+ * split: The split
+ *
+ * first: Index of the first move pushed
+ *
+ * last: Index of the last move pushed
+ */
+static void push_jobs(ParallelRun* run, JobDeque* deque, Split* split,
+        int first, int last);
+
+/*
+ * Takes the newest job from the deque of the thread.
+ *
+ * deque: The deque of the thread
+ *
+ * job: Where the job is returned
+ *
+ * return: Returns true if there was a job
+ */
+static bool pop_job(JobDeque* deque, Job* job);
+
+/*
+ * Takes the oldest job from the deque of another thread.
+ *
+ * deque: The deque of the other thread
+ *
+ * job: Where the job is returned
+ *
+ * return: Returns true if there was a job
+ */
+static bool steal_job(JobDeque* deque, Job* job);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+bool parallel_search_move(GameStateInfo* state) {
+    int64_t start = search_clock();
+    SearchOptions* options = get_search_options();
+    ParallelRun run;
+    run.threads = search_thread_count();
+    run.search = get_search(state, run.threads);
+    if (run.search->sharedTable == NULL) {
+        run.search->sharedTable = create_trans_table(SHARED_TABLE_BITS);
+    }
+    if (run.search->pool == NULL) {
+        run.search->pool = create_thread_pool(run.threads);
+    }
+    int stop = 0;
+    int64_t deadline = move_deadline(state, start);
+    SearchWorker* workers = run.search->workers;
+    for (int i = 0; i < run.threads; i++) {
+        workers[i].table = run.search->sharedTable;
+        workers[i].repeatable = true;
+        workers[i].nodes = 0;
+        workers[i].probes = 0;
+        workers[i].hits = 0;
+        workers[i].deadline = deadline;
+        workers[i].stop = deadline == NO_DEADLINE ? NULL : &stop;
+    }
+    SearchBoard root;
+    init_search_board(&root, run.search->setup);
+    load_search_board(&root, state);
+    run.root = &root;
+    run.deques = mem_malloc(MEM_AUTO_PLAYER, sizeof(JobDeque) * run.threads);
+    for (int i = 0; i < run.threads; i++) {
+        pthread_mutex_init(&run.deques[i].lock, NULL);
+    }
+    run.splits = mem_malloc(MEM_AUTO_PLAYER, sizeof(Split) * MAX_SPLITS);
+    pthread_mutex_init(&run.lock, NULL);
+    pthread_cond_init(&run.work, NULL);
+
+    // without a deadline only the one depth is searched
+    int depth = deadline == NO_DEADLINE ? options->depth : 1;
+    int maxDepth = deadline == NO_DEADLINE ? options->depth : MAX_DEPTH;
+    int reached = 0;
+    Placement best;
+    for (; depth <= maxDepth; depth++) {
+        int score = search_depth(&run, state->tileIndex, depth);
+        if (stop) {
+            break;
+        }
+        best = run.splits[0].moves[run.best];
+        reached = depth;
+        if (!search_deeper(score, start, deadline)) {
+            break;
+        }
+    }
+
+    for (int i = 0; i < run.threads; i++) {
+        workers[i].stop = NULL;
+        workers[i].deadline = NO_DEADLINE;
+    }
+    int64_t end = search_clock();
+    run.search->spent[state->turn] += end - start;
+    if (reached > 0) {
+        placement_to_inst(run.search->setup, state->tileIndex, &best,
+                state->inst);
+    }
+    print_search_stats(state, workers, run.threads, reached,
+            (double)(end - start) / SECOND_NS);
+    for (int i = 0; i < run.threads; i++) {
+        pthread_mutex_destroy(&run.deques[i].lock);
+    }
+    pthread_cond_destroy(&run.work);
+    pthread_mutex_destroy(&run.lock);
+    mem_free(MEM_AUTO_PLAYER, run.deques);
+    mem_free(MEM_AUTO_PLAYER, run.splits);
+    free_search_board(&root);
+    return reached > 0;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int search_depth(ParallelRun* run, int tileIndex, int depth) {
+    SearchWorker* workers = run->search->workers;
+    for (int i = 0; i < run->threads; i++) {
+        run->deques[i].top = 0;
+        run->deques[i].bottom = 0;
+    }
+    run->splitCount = 1;
+    run->queued = 0;
+    run->done = 0;
+
+    // the first root move is the first job
+    Split* rootSplit = &run->splits[0];
+    rootSplit->parent = NULL;
+    rootSplit->tileIndex = tileIndex;
+    rootSplit->depth = depth;
+    rootSplit->ply = 0;
+    copy_search_board(&workers[0].board, run->root);
+    rootSplit->moveCount = collect_moves(&workers[0], tileIndex, NO_MOVE,
+            rootSplit->moves);
+    push_jobs(run, &run->deques[0], rootSplit, 0, 0);
+
+    // the calling thread is one of the threads of the pool
+    run_pool_jobs(run->search->pool, run->threads, run_thread, run);
+    return rootSplit->scores[run->best];
+}
+
+//
+static void run_thread(int id, int thread, void* run) {
+    ParallelRun* parallel = run;
+    Job job;
+    while (!__atomic_load_n(&parallel->done, __ATOMIC_ACQUIRE)) {
+        bool found = pop_job(&parallel->deques[id], &job);
+        // look for work on the other threads in turn
+        for (int i = 1; !found && i < parallel->threads; i++) {
+            found = steal_job(&parallel->deques[(id + i) %
+                    parallel->threads], &job);
+        }
+        if (found) {
+            __atomic_sub_fetch(&parallel->queued, 1, __ATOMIC_RELAXED);
+            run_job(parallel, id, &job);
+            continue;
+        }
+        // sleep until a job is pushed rather than spin
+        pthread_mutex_lock(&parallel->lock);
+        while (!__atomic_load_n(&parallel->done, __ATOMIC_ACQUIRE) &&
+                __atomic_load_n(&parallel->queued, __ATOMIC_RELAXED) == 0) {
+            pthread_cond_wait(&parallel->work, &parallel->lock);
+        }
+        pthread_mutex_unlock(&parallel->lock);
+    }
+}
+
+//
+static void run_job(ParallelRun* run, int id, Job* job) {
+    SearchWorker* worker = &run->search->workers[id];
+    LoadedTilefile* tiles = run->search->setup->tiles;
+    Split* split = job->split;
+    copy_search_board(&worker->board, run->root);
+    play_path(&worker->board, split);
+    set_placement(&worker->board, split->tileIndex,
+            &split->moves[job->move], 1);
+    int tileIndex = next_tile(tiles, split->tileIndex);
+    int depth = split->depth - 1;
+    int ply = split->ply + 1;
+    if (job->move > 0) {
+        // a brother only has to show whether it beats the first move
+        int alpha = split->alpha;
+        int score = -search_position(worker, tileIndex, depth, -alpha - 1,
+                -alpha, ply);
+        if (score > alpha) {
+            // a full window gives the exact score whatever the table holds
+            score = -search_position(worker, tileIndex, depth,
+                    -INFINITE_SCORE, INFINITE_SCORE, ply);
+        }
+        finish_move(run, id, split, job->move, score);
+        return;
+    }
+    if (ply >= SPLIT_PLIES || depth < MIN_SPLIT_DEPTH) {
+        finish_move(run, id, split, 0, -search_position(worker, tileIndex,
+                depth, -INFINITE_SCORE, INFINITE_SCORE, ply));
+        return;
+    }
+    Split* child = &run->splits[__atomic_fetch_add(&run->splitCount, 1,
+            __ATOMIC_RELAXED)];
+    child->parent = split;
+    child->parentMove = job->move;
+    child->tileIndex = tileIndex;
+    child->depth = depth;
+    child->ply = ply;
+    child->moveCount = collect_moves(worker, tileIndex, NO_MOVE,
+            child->moves);
+    if (child->moveCount == 0) {
+        // the player to move at the child has lost
+        finish_move(run, id, split, job->move, WIN_SCORE - ply);
+        return;
+    }
+    push_jobs(run, &run->deques[id], child, 0, 0);
+}
+
+//
+static void finish_move(ParallelRun* run, int id, Split* split, int move,
+        int score) {
+    split->scores[move] = score;
+    if (move == 0 && split->moveCount > 1) {
+        // the brothers were waiting for the score to beat
+        split->alpha = score;
+        split->pending = split->moveCount - 1;
+        push_jobs(run, &run->deques[id], split, 1, split->moveCount - 1);
+        return;
+    }
+    if (move > 0 && __atomic_sub_fetch(&split->pending, 1,
+            __ATOMIC_ACQ_REL) > 0) {
+        return;
+    }
+    // ties go to the first move so the result never varies. A move that
+    // did not beat the first has a score no higher than it
+    int best = 0;
+    for (int i = 1; i < split->moveCount; i++) {
+        if (split->scores[i] > split->scores[best]) {
+            best = i;
+        }
+    }
+    if (split->parent == NULL) {
+        run->best = best;
+        pthread_mutex_lock(&run->lock);
+        __atomic_store_n(&run->done, 1, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&run->work);
+        pthread_mutex_unlock(&run->lock);
+    } else {
+        finish_move(run, id, split->parent, split->parentMove,
+                -split->scores[best]);
+    }
+}
+
+//
+static void play_path(SearchBoard* board, Split* split) {
+    if (split->parent == NULL) {
+        return;
+    }
+    play_path(board, split->parent);
+    set_placement(board, split->parent->tileIndex,
+            &split->parent->moves[split->parentMove], 1);
+}
+
+//
+static void push_jobs(ParallelRun* run, JobDeque* deque, Split* split,
+        int first, int last) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->top == deque->bottom) {
+        deque->top = 0;
+        deque->bottom = 0;
+    }
+    for (int i = last; i >= first; i--) {
+        deque->jobs[deque->bottom].split = split;
+        deque->jobs[deque->bottom].move = i;
+        deque->bottom++;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    pthread_mutex_lock(&run->lock);
+    __atomic_add_fetch(&run->queued, last - first + 1, __ATOMIC_RELAXED);
+    pthread_cond_broadcast(&run->work);
+    pthread_mutex_unlock(&run->lock);
+}
+
+//
+static bool pop_job(JobDeque* deque, Job* job) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->bottom > deque->top;
+    if (found) {
+        *job = deque->jobs[--deque->bottom];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+//
+static bool steal_job(JobDeque* deque, Job* job) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->bottom > deque->top;
+    if (found) {
+        *job = deque->jobs[deque->top++];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
\ No newline at end of file
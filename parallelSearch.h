@@ -0,0 +1,36 @@
+/*
+ * parallelSearch.h
+ * Author: Michael Bossner
+ *
+ * Header file for parallelSearch.c
+ */
+
+#ifndef PARALLEL_SEARCH_H
+#define PARALLEL_SEARCH_H
+
+#include <stdbool.h>
+
+#include "game.h"
+
+#define APT4 '4'
+
+/*
+ * Chooses a move for the current player with the same search as the search
+ * player spread over --search-threads threads. Near the root each move is
+ * a job and every thread runs the jobs of its own deque, stealing from the
+ * others when it has none. The first move of a position is searched before
+ * its other moves are pushed, and every thread shares one transposition
+ * table. The threads are kept for the game. The move chosen
+ * only depends on the position and the search options, never on the number
+ * of threads or the order the jobs finish in, unless there is a time limit.
+ * With --move-time or --game-time the search deepens one move at a time as
+ * search_move does.
+ * Updates state->inst with the move chosen.
+ *
+ * state: The current state of the game. There must be a valid move
+ *
+ * return: Returns false if the time ran out before any search finished
+ */
+bool parallel_search_move(GameStateInfo* state);
+
+#endif
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 #include "parseFile.h"
 #include "error.h"
+#include "memStats.h"
 
 #define FOREVER for (;;)
 
@@ -17,34 +18,36 @@
 
 void split_stdin(FileCont* splitStdIn) {
     splitStdIn->sizeOfOut = 0;
-    splitStdIn->output = malloc(sizeof(char*) * 1);
-    splitStdIn->output[0] = malloc(sizeof(char) * 1);            
+    splitStdIn->subsystem = MEM_PARSER;
+    splitStdIn->output = mem_malloc(MEM_PARSER, sizeof(char*) * 1);
+    splitStdIn->output[0] = mem_malloc(MEM_PARSER, sizeof(char) * 1);
     int next;
     // parse through stdin and split each word into it's own string
     FOREVER {
+        char** word = &splitStdIn->output[splitStdIn->sizeOfOut];
         for (int strLen = 0; ; strLen++) {
             next = fgetc(stdin);
             if ((splitStdIn->sizeOfOut == 0 && strLen == 0 && next == EOF)) {
                 // EOF received while waiting for input
+                mem_free(MEM_PARSER, *word);
+                free_file_cont(splitStdIn);
                 error_10();
             } else if ((next == '\n') || (next == ' ') || (next == EOF)) {
                 // End of the word. Finish string and break loop
-                splitStdIn->output[splitStdIn->sizeOfOut] = 
-                        realloc(splitStdIn->output[splitStdIn->sizeOfOut], 
+                *word = mem_realloc(MEM_PARSER, *word,
                         sizeof(char) * (strLen + 1));
                 if (strLen) {
-                    splitStdIn->output[splitStdIn->sizeOfOut][strLen] = '\0';
+                    (*word)[strLen] = '\0';
                 } else {
                     // multiple spaces in a row.
-                    splitStdIn->output[splitStdIn->sizeOfOut][strLen] = ' ';
+                    (*word)[strLen] = ' ';
                 }
                 break;
             } else {
                 // Middle of a word add character to string
-                splitStdIn->output[splitStdIn->sizeOfOut] = 
-                        realloc(splitStdIn->output[splitStdIn->sizeOfOut], 
+                *word = mem_realloc(MEM_PARSER, *word,
                         sizeof(char) * (strLen + 1));
-                splitStdIn->output[splitStdIn->sizeOfOut][strLen] = next;
+                (*word)[strLen] = next;
             }
         }
         splitStdIn->sizeOfOut++;
@@ -55,32 +58,32 @@ void split_stdin(FileCont* splitStdIn) {
             break;
         } else {
             // More words remaining. Add additional storage to store new string
-            splitStdIn->output = realloc(splitStdIn->output, 
+            splitStdIn->output = mem_realloc(MEM_PARSER, splitStdIn->output,
                     sizeof(char*) * (splitStdIn->sizeOfOut + 1));
-            splitStdIn->output[splitStdIn->sizeOfOut] = 
-                    malloc(sizeof(char) * 1);
+            splitStdIn->output[splitStdIn->sizeOfOut] =
+                    mem_malloc(MEM_PARSER, sizeof(char) * 1);
         }
     }
 }
 
-void split_file(FILE* file, FileCont* splitFile) {
+void split_file(FILE* file, FileCont* splitFile, int subsystem) {
     splitFile->sizeOfOut = 0;
-    splitFile->output = malloc(sizeof(char*) * 1);
-    splitFile->output[0] = malloc(sizeof(char) * 1);            
+    splitFile->subsystem = subsystem;
+    splitFile->output = mem_malloc(subsystem, sizeof(char*) * 1);
+    splitFile->output[0] = mem_malloc(subsystem, sizeof(char) * 1);
     int next;
     // parse file and split each line into it's own string
     FOREVER {
+        char** line = &splitFile->output[splitFile->sizeOfOut];
         for (int strLen = 0; ; strLen++) {
             next = fgetc(file);
-            splitFile->output[splitFile->sizeOfOut] = 
-                    realloc(splitFile->output[splitFile->sizeOfOut], 
-                    sizeof(char) * (strLen + 1));
+            *line = mem_realloc(subsystem, *line, sizeof(char) * (strLen + 1));
             if ((next == '\n') || (next == EOF)) {
                 // End of line null terminate string and break         
-                splitFile->output[splitFile->sizeOfOut][strLen] = '\0';
+                (*line)[strLen] = '\0';
                 break;
             } else {
-                splitFile->output[splitFile->sizeOfOut][strLen] = next;
+                (*line)[strLen] = next;
             }
         }
         splitFile->sizeOfOut++;
@@ -88,10 +91,17 @@ void split_file(FILE* file, FileCont* splitFile) {
             break;
         } else {
             // More lines remaining. Add additional storage for new string.
-            splitFile->output = realloc(splitFile->output, 
+            splitFile->output = mem_realloc(subsystem, splitFile->output,
                     sizeof(char*) * (splitFile->sizeOfOut + 1));
-            splitFile->output[splitFile->sizeOfOut] = 
-                    malloc(sizeof(char) * 1);
+            splitFile->output[splitFile->sizeOfOut] =
+                    mem_malloc(subsystem, sizeof(char) * 1);
         }
     }
+}
+
+void free_file_cont(FileCont* fileCont) {
+    for (int i = 0; i < fileCont->sizeOfOut; i++) {
+        mem_free(fileCont->subsystem, fileCont->output[i]);
+    }
+    mem_free(fileCont->subsystem, fileCont->output);
 }
\ No newline at end of file
@@ -18,6 +18,7 @@ typedef struct FileCont FileCont;
 struct FileCont {
     int sizeOfOut; // size of container
     char** output; // Output from the parsed input
+    int subsystem; // Who the output is allocated for. One of the MEM_ defines
 };
 
 /*
@@ -37,7 +38,16 @@ void split_stdin(FileCont* splitStdIn);
  * file: the file to be parsed
  * 
  * splitFile: the container to place the output of the parsing
+ *
+ * subsystem: who the output is allocated for. One of the MEM_ defines
+ */
+void split_file(FILE* file, FileCont* splitFile, int subsystem);
+
+/*
+ * Frees the output stored in a container by split_stdin or split_file.
+ *
+ * fileCont: the container to be freed
  */
-void split_file(FILE* file, FileCont* splitFile);
+void free_file_cont(FileCont* fileCont);
 
 #endif
\ No newline at end of file
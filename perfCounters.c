@@ -0,0 +1,198 @@
+/*
+ * perfCounters.c
+ * Author: Michael Bossner
+ *
+ * This file contains the hardware counters read by --perf. The counters of
+ * each thread are opened as one perf_event_open group so a single read gets
+ * all of them at the same moment. Only user space is counted so they work
+ * with the default perf_event_paranoid setting. Where the kernel does not
+ * allow them, such as in most containers and virtual machines, nothing is
+ * opened and only the times are reported.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "perfCounters.h"
+
+#define NO_GROUP -1
+#define THIS_THREAD 0
+#define ANY_CPU -1
+#define CACHE_OP_SHIFT 8
+#define CACHE_RESULT_SHIFT 16
+
+typedef struct ThreadCounters ThreadCounters;
+
+/*
+ * The counters opened by one thread
+ */
+struct ThreadCounters {
+    int fds[PERF_COUNTERS]; // Each counter. -1 if it is not open
+    int leader; // The counter the others are grouped under. -1 if none
+    int count; // Number of counters opened
+    /* Each counter opened in the order they are in a group read */
+    int order[PERF_COUNTERS];
+};
+
+// Whether enable_perf_counters found any counter
+static bool enabled = false;
+// Whether each counter could be opened
+static bool available[PERF_COUNTERS];
+// The ThreadCounters of each thread that has read its counters
+static pthread_key_t countersKey;
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Opens the counters of the calling thread.
+ *
+ * counters: Where the counters are returned
+ *
+ * wanted: Which counters to try
+ */
+static void open_counters(ThreadCounters* counters, bool* wanted);
+
+/*
+ * Opens one counter of the calling thread.
+ *
+ * counter: The counter. One of the PERF_ defines
+ *
+ * group: The leader of the group it joins or NO_GROUP to lead its own
+ *
+ * return: Returns the file descriptor of the counter or -1 if it can't be
+ *         opened
+ */
+static int open_counter(int counter, int group);
+
+/*
+ * Closes the counters of a thread that has ended. Registered with
+ * pthread_key_create.
+ *
+ * counters: The ThreadCounters of the thread
+ */
+static void close_counters(void* counters);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+bool enable_perf_counters(void) {
+    if (enabled) {
+        return true;
+    }
+    ThreadCounters* counters = malloc(sizeof(ThreadCounters));
+    bool wanted[PERF_COUNTERS];
+    for (int i = 0; i < PERF_COUNTERS; i++) {
+        wanted[i] = true;
+    }
+    open_counters(counters, wanted);
+    if (counters->count == 0) {
+        free(counters);
+        return false;
+    }
+    for (int i = 0; i < PERF_COUNTERS; i++) {
+        available[i] = counters->fds[i] >= 0;
+    }
+    pthread_key_create(&countersKey, close_counters);
+    pthread_setspecific(countersKey, counters);
+    enabled = true;
+    return true;
+}
+
+bool perf_counter_available(int counter) {
+    return enabled && available[counter];
+}
+
+bool read_perf_counters(uint64_t counts[PERF_COUNTERS]) {
+    if (!enabled) {
+        return false;
+    }
+    ThreadCounters* counters = pthread_getspecific(countersKey);
+    if (counters == NULL) {
+        counters = malloc(sizeof(ThreadCounters));
+        open_counters(counters, available);
+        pthread_setspecific(countersKey, counters);
+    }
+    // a group read is the number of counters then the value of each
+    uint64_t values[PERF_COUNTERS + 1];
+    ssize_t size = sizeof(uint64_t) * (counters->count + 1);
+    if (counters->count == 0 ||
+            read(counters->leader, values, size) != size) {
+        return false;
+    }
+    memset(counts, 0, sizeof(uint64_t) * PERF_COUNTERS);
+    for (int i = 0; i < counters->count; i++) {
+        counts[counters->order[i]] = values[i + 1];
+    }
+    return true;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void open_counters(ThreadCounters* counters, bool* wanted) {
+    counters->leader = NO_GROUP;
+    counters->count = 0;
+    for (int i = 0; i < PERF_COUNTERS; i++) {
+        counters->fds[i] = wanted[i] ? open_counter(i, counters->leader) : -1;
+        if (counters->fds[i] < 0) {
+            continue;
+        }
+        if (counters->leader == NO_GROUP) {
+            counters->leader = counters->fds[i];
+        }
+        counters->order[counters->count++] = i;
+    }
+}
+
+//
+static int open_counter(int counter, int group) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    switch (counter) {
+        case PERF_CYCLES:
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_INSTRUCTIONS:
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_L1_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D |
+                    (PERF_COUNT_HW_CACHE_OP_READ << CACHE_OP_SHIFT) |
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << CACHE_RESULT_SHIFT);
+            break;
+        case PERF_LLC_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL |
+                    (PERF_COUNT_HW_CACHE_OP_READ << CACHE_OP_SHIFT) |
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << CACHE_RESULT_SHIFT);
+            break;
+        default:
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+    }
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attr, THIS_THREAD, ANY_CPU, group,
+            0);
+}
+
+//
+static void close_counters(void* counters) {
+    ThreadCounters* thread = counters;
+    for (int i = 0; i < PERF_COUNTERS; i++) {
+        if (thread->fds[i] >= 0) {
+            close(thread->fds[i]);
+        }
+    }
+    free(thread);
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+/*
+ * perfCounters.h
+ * Author: Michael Bossner
+ *
+ * Header file for perfCounters.c
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PERF_CYCLES 0
+#define PERF_INSTRUCTIONS 1
+#define PERF_L1_MISSES 2
+#define PERF_LLC_MISSES 3
+#define PERF_BRANCH_MISSES 4
+#define PERF_COUNTERS 5
+
+/*
+ * Opens the hardware counters of the calling thread to find which of them
+ * the kernel and processor allow. Other threads open the same counters the
+ * first time they read them.
+ *
+ * return: Returns false if none of the counters can be opened
+ */
+bool enable_perf_counters(void);
+
+/*
+ * Gets whether a counter could be opened by enable_perf_counters.
+ *
+ * counter: The counter. One of the PERF_ defines
+ *
+ * return: Returns true if the counter is counted
+ */
+bool perf_counter_available(int counter);
+
+/*
+ * Reads every counter of the calling thread. The values only mean something
+ * as the difference between two reads on the same thread.
+ *
+ * counts: Where the value of each counter is returned. Counters that are
+ *         not available are 0
+ *
+ * return: Returns false if the counters are off or can't be read
+ */
+bool read_perf_counters(uint64_t counts[PERF_COUNTERS]);
+
+#endif
\ No newline at end of file
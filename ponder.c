@@ -0,0 +1,258 @@
+/*
+ * ponder.c
+ * Author: Michael Bossner
+ *
+ * This file contains the search the search player makes while a human is
+ * choosing their move. The tile the human places and the one the search
+ * player places after it are both known, so every move of the human is
+ * played out one at a time, best looking first, and the reply to each is
+ * searched on a thread of its own. The reply is kept with the key of the
+ * position so it can be played straight away, and everything searched stays
+ * in the transposition table for the moves that were not guessed.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "ponder.h"
+#include "searchPlayer.h"
+#include "searchBoard.h"
+#include "transTable.h"
+#include "tilefile.h"
+#include "game.h"
+#include "memStats.h"
+
+typedef struct PonderReply PonderReply;
+
+/*
+ * The reply to one move of the opponent
+ */
+struct PonderReply {
+    uint64_t key; // position_key of the position after the move
+    Placement move; // The reply found by the search
+};
+
+/*
+ * Everything pondering keeps for a game
+ */
+struct Ponder {
+    SearchWorker worker; // The worker of the thread
+    pthread_t thread; // The thread searching
+    bool running; // Whether the thread has not been waited for
+    bool pondered; // Whether the replies are for the latest opponent turn
+    int stop; // Set to end the search
+    int tileIndex; // Index of the tile the opponent places
+    Placement* guesses; // Moves of the opponent, best looking first
+    int guessCount; // Number of guesses
+    PonderReply* replies; // Replies to the guesses searched so far
+    int searched; // Number of guesses searched to the end
+};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Searches the reply to each guess in turn until every guess is searched or
+ * the search is stopped.
+ *
+ * arg: The Ponder of the game
+ *
+ * return: Returns NULL
+ */
+static void* run_ponder(void* arg);
+
+/*
+ * Lists every move of the opponent, best looking first. Moves are ordered
+ * by how few placements they leave the search player as in collect_moves.
+ * None are listed once pondering is told to stop.
+ *
+ * ponder: What pondering keeps. The board of its worker holds the position
+ */
+static void list_guesses(Ponder* ponder);
+
+/*
+ * Orders moves for qsort by their scores.
+ *
+ * a: The first move
+ *
+ * b: The second move
+ *
+ * return: Returns less than, equal to or more than 0 as the score of a is
+ *         less than, equal to or more than the score of b
+ */
+static int compare_moves(const void* a, const void* b);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+void start_ponder(GameStateInfo* state) {
+    char opponent = state->player == PLAYER_1 ? state->p2Type : state->p1Type;
+    if (!get_search_options()->ponder || opponent != APT3) {
+        return;
+    }
+    Search* search = get_search(state, 1);
+    if (search->table == NULL) {
+        search->table = create_trans_table(SEARCH_TABLE_BITS);
+    }
+    Ponder* ponder = search->ponder;
+    if (ponder == NULL) {
+        ponder = mem_malloc(MEM_AUTO_PLAYER, sizeof(Ponder));
+        // the centre of a tile can be off the board
+        int placements = (state->height - 2 * MIN_MOVE) *
+                (state->width - 2 * MIN_MOVE) * ROTATIONS;
+        ponder->guesses = mem_malloc(MEM_AUTO_PLAYER,
+                sizeof(Placement) * placements);
+        ponder->replies = mem_malloc(MEM_AUTO_PLAYER,
+                sizeof(PonderReply) * placements);
+        init_search_board(&ponder->worker.board, search->setup);
+        ponder->worker.table = search->table;
+        ponder->worker.repeatable = false;
+        ponder->worker.stop = &ponder->stop;
+        ponder->worker.deadline = NO_DEADLINE;
+        ponder->running = false;
+        search->ponder = ponder;
+    }
+    load_search_board(&ponder->worker.board, state);
+    ponder->worker.nodes = 0;
+    ponder->worker.probes = 0;
+    ponder->worker.hits = 0;
+    ponder->stop = 0;
+    ponder->tileIndex = state->tileIndex;
+    ponder->guessCount = 0;
+    ponder->searched = 0;
+    ponder->pondered = true;
+    // without the thread the search player only loses its head start
+    ponder->running = pthread_create(&ponder->thread, NULL, run_ponder,
+            ponder) == 0;
+}
+
+void stop_ponder(GameStateInfo* state) {
+    Search* search = state->search;
+    if (search == NULL || search->ponder == NULL ||
+            !search->ponder->running) {
+        return;
+    }
+    Ponder* ponder = search->ponder;
+    __atomic_store_n(&ponder->stop, 1, __ATOMIC_RELAXED);
+    pthread_join(ponder->thread, NULL);
+    ponder->running = false;
+}
+
+bool ponder_move(GameStateInfo* state) {
+    Search* search = state->search;
+    if (search == NULL || search->ponder == NULL ||
+            !search->ponder->pondered) {
+        return false;
+    }
+    Ponder* ponder = search->ponder;
+    ponder->pondered = false;
+    SearchBoard* board = &get_search(state, 1)->workers[0].board;
+    load_search_board(board, state);
+    uint64_t key = position_key(board, state->tileIndex);
+    int found = NO_MOVE;
+    for (int i = 0; i < ponder->searched && found == NO_MOVE; i++) {
+        if (ponder->replies[i].key == key) {
+            found = i;
+        }
+    }
+    if (get_search_options()->stats) {
+        fprintf(stderr, "Player %c ponder: %d of %d guesses searched, %s, "
+                "nodes %lu\n", state->player, ponder->searched,
+                ponder->guessCount, found == NO_MOVE ? "missed" : "hit",
+                ponder->worker.nodes);
+    }
+    if (found == NO_MOVE) {
+        return false;
+    }
+    placement_to_inst(search->setup, state->tileIndex,
+            &ponder->replies[found].move, state->inst);
+    return true;
+}
+
+void free_ponder(Ponder* ponder) {
+    if (ponder->running) {
+        __atomic_store_n(&ponder->stop, 1, __ATOMIC_RELAXED);
+        pthread_join(ponder->thread, NULL);
+    }
+    free_search_board(&ponder->worker.board);
+    mem_free(MEM_AUTO_PLAYER, ponder->guesses);
+    mem_free(MEM_AUTO_PLAYER, ponder->replies);
+    mem_free(MEM_AUTO_PLAYER, ponder);
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void* run_ponder(void* arg) {
+    Ponder* ponder = arg;
+    SearchWorker* worker = &ponder->worker;
+    int reply = next_tile(worker->board.setup->tiles, ponder->tileIndex);
+    list_guesses(ponder);
+    for (int i = 0; i < ponder->guessCount; i++) {
+        PonderReply* found = &ponder->replies[ponder->searched];
+        set_placement(&worker->board, ponder->tileIndex, &ponder->guesses[i],
+                1);
+        found->key = position_key(&worker->board, reply);
+        search_position(worker, reply, get_search_options()->depth,
+                -INFINITE_SCORE, INFINITE_SCORE, 0);
+        set_placement(&worker->board, ponder->tileIndex, &ponder->guesses[i],
+                0);
+        if (__atomic_load_n(&ponder->stop, __ATOMIC_RELAXED)) {
+            break;
+        }
+        found->move = worker->best;
+        ponder->searched++;
+    }
+    return NULL;
+}
+
+//
+static void list_guesses(Ponder* ponder) {
+    SearchBoard* board = &ponder->worker.board;
+    SearchSetup* setup = board->setup;
+    TileShape* shape = get_tile_shape(setup->tiles, ponder->tileIndex);
+    int reply = next_tile(setup->tiles, ponder->tileIndex);
+    // a guess leaves the reply every placement it does not overlap
+    Overlap overlaps[ROTATIONS][MAX_OVERLAPS];
+    int overlapCounts[ROTATIONS];
+    find_overlaps(setup, setup->tiles->tileShape[ponder->tileIndex],
+            setup->tiles->tileShape[reply], overlaps, overlapCounts);
+    int replies = count_fits(board, reply);
+    int count = 0;
+    Placement move;
+    for (move.rotation = 0; move.rotation < shape->distinct;
+            move.rotation++) {
+        RotationCells* cells = get_rotation_cells(setup, ponder->tileIndex,
+                move.rotation);
+        for (move.colm = -cells->minY;
+                move.colm < setup->height - cells->maxY; move.colm++) {
+            for (move.row = -cells->minX;
+                    move.row < setup->width - cells->maxX; move.row++) {
+                if (!fits_at(board, cells, shape->cellCount,
+                        move.colm * setup->width + move.row)) {
+                    continue;
+                }
+                // a large board has many guesses to score
+                if (__atomic_load_n(&ponder->stop, __ATOMIC_RELAXED)) {
+                    ponder->guessCount = 0;
+                    return;
+                }
+                move.score = replies - count_overlapped(board, reply, &move,
+                        overlaps[move.rotation],
+                        overlapCounts[move.rotation]);
+                ponder->guesses[count++] = move;
+            }
+        }
+    }
+    // the moves that leave the fewest replies are the likeliest
+    qsort(ponder->guesses, count, sizeof(Placement), compare_moves);
+    ponder->guessCount = count;
+}
+
+//
+static int compare_moves(const void* a, const void* b) {
+    const Placement* first = a;
+    const Placement* second = b;
+    return (first->score > second->score) - (first->score < second->score);
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+/*
+ * ponder.h
+ * Author: Michael Bossner
+ *
+ * Header file for ponder.c
+ */
+
+#ifndef PONDER_H
+#define PONDER_H
+
+#include <stdbool.h>
+
+#include "game.h"
+
+typedef struct Ponder Ponder;
+
+/*
+ * Starts searching on another thread while a human chooses a move against
+ * the search player. Every move the human can make is searched in turn,
+ * likeliest first, for the reply of the search player with the next tile.
+ * Does nothing unless --ponder is given.
+ *
+ * state: The current state of the game. The human is the current player
+ */
+void start_ponder(GameStateInfo* state);
+
+/*
+ * Ends the search started by start_ponder and waits for its thread. The
+ * replies already found and the positions in the transposition table are
+ * kept for the search player's turn.
+ *
+ * state: The current state of the game
+ */
+void stop_ponder(GameStateInfo* state);
+
+/*
+ * Looks up the reply found while the opponent was choosing their move.
+ * Updates state->inst with the move found.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns true if the reply to the move the opponent made was
+ *         searched to the end
+ */
+bool ponder_move(GameStateInfo* state);
+
+/*
+ * Ends any search still running and frees what pondering kept for a game.
+ *
+ * ponder: What pondering kept
+ */
+void free_ponder(Ponder* ponder);
+
+#endif
\ No newline at end of file
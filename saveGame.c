@@ -13,6 +13,10 @@
 #include "saveGame.h"
 #include "error.h"
 #include "parseFile.h"
+#include "stats.h"
+#include "trace.h"
+#include "flightRecorder.h"
+#include "memStats.h"
 
 #define LINE_1 0
 #define INDEX 0
@@ -70,11 +74,21 @@ static int load_board(FileCont* splitFile, GameStateInfo* state);
 //////////////////////////////// Functions ////////////////////////////////////
 
 int save_game(char* fileName, GameStateInfo* state) {
+    PhaseStart start;
+    start_phase(&start);
+    trace_begin(TRACE_SAVE, state);
     FILE* saveFile = fopen(fileName, "w");
-    if (saveFile == NULL) {
-        return INVALID;
+    if (saveFile != NULL) {
+        write_save(saveFile, state);
+        fclose(saveFile);
     }
+    trace_end(TRACE_SAVE);
+    record_flight(FLIGHT_SAVE, state, saveFile != NULL, 0, 0, fileName);
+    end_phase(PHASE_SAVE_GAME, &start);
+    return saveFile == NULL ? INVALID : VALID;
+}
 
+void write_save(FILE* saveFile, GameStateInfo* state) {
     fprintf(saveFile, "%d %d %d %d\n", state->tileIndex, state->turn, 
             state->height, state->width);
     // writes the board to the save file
@@ -84,29 +98,46 @@ int save_game(char* fileName, GameStateInfo* state) {
         }
         fprintf(saveFile, "\n");
     }
-    fclose(saveFile);
-    return VALID;
 }
 
 int load_game(char* fileName, GameStateInfo* state,
         LoadedTilefile* loadedFile) {
-    FILE* saveFile = fopen(fileName, "r");
-    FileCont splitFile;
-    if (saveFile == NULL) {
-        free_loaded_tiles(loadedFile);
-        error_6();
-    } else {
-        split_file(saveFile, &splitFile);
-        if (!is_save_file_valid(&splitFile, state, loadedFile)) {
+    switch (read_save_file(fileName, state, loadedFile)) {
+        case SAVE_NO_ACCESS:
+            free_loaded_tiles(loadedFile);
+            error_6();
+
+        case SAVE_INVALID:
             // invalid file contents
             error_7();
-        }
     }
-
-    fclose(saveFile);
     return VALID;
 }
 
+int read_save_file(char* fileName, GameStateInfo* state, 
+        LoadedTilefile* loadedFile) {
+    PhaseStart start;
+    start_phase(&start);
+    FILE* saveFile = fopen(fileName, "r");
+    int status = SAVE_NO_ACCESS;
+    if (saveFile != NULL) {
+        status = read_save(saveFile, state, loadedFile);
+        fclose(saveFile);
+    }
+    record_flight(FLIGHT_LOAD, NULL, status, 0, 0, fileName);
+    end_phase(PHASE_LOAD_GAME, &start);
+    return status;
+}
+
+int read_save(FILE* saveFile, GameStateInfo* state, 
+        LoadedTilefile* loadedFile) {
+    FileCont splitFile;
+    split_file(saveFile, &splitFile, MEM_SAVE);
+    bool valid = is_save_file_valid(&splitFile, state, loadedFile);
+    free_file_cont(&splitFile);
+    return valid ? SAVE_LOADED : SAVE_INVALID;
+}
+
 ////////////////////////////// Private Functions //////////////////////////////
 //
 static bool is_save_file_valid(FileCont* splitFile, GameStateInfo* state, 
@@ -173,17 +204,17 @@ static int load_board(FileCont* splitFile, GameStateInfo* state) {
     if (state->height != (splitFile->sizeOfOut - NON_BOARD_LINES)) {
         return INVALID;
     }
-    // Create board from save file and store it in the game state
-    state->board = malloc(sizeof(char*) * state->height);
+    // check every row before the board is created
     for (int colm = 0; colm < state->height; colm++) {
-        state->board[colm] = malloc(sizeof(char) * state->width);           
         if (state->width != strlen(splitFile->output[colm + 1])) {
             return INVALID;
-        } else {
-            for (int row = 0; row < state->width; row++) {
-                state->board[colm][row] = splitFile->output[colm + 1][row];
-            }
         }
     }
+    // Create board from save file and store it in the game state
+    state->board = alloc_board(state->height, state->width);
+    for (int colm = 0; colm < state->height; colm++) {
+        memcpy(state->board[colm], splitFile->output[colm + 1],
+                state->width);
+    }
     return VALID;
 }
\ No newline at end of file
@@ -9,6 +9,11 @@
 #define SAVE_GAME_H
 
 #define SAVE_NAME_START 4
+#define SAVE_LOADED 0
+#define SAVE_NO_ACCESS 1
+#define SAVE_INVALID 2
+
+#include <stdio.h>
 
 #include "game.h"
 #include "tilefile.h"
@@ -27,6 +32,15 @@
  */
 int save_game(char* fileName, GameStateInfo* state);
 
+/*
+ * Writes the current state of the game in the save file format.
+ *
+ * saveFile: The open file to write the save too
+ *
+ * state: The current state of the game
+ */
+void write_save(FILE* saveFile, GameStateInfo* state);
+
 /*
  * Attempts to load a save game file. Checks the file to see if it is valid.
  * Updates the game state with the information contained in the file.
@@ -46,4 +60,37 @@ int save_game(char* fileName, GameStateInfo* state);
 int load_game(char* fileName, GameStateInfo* state, 
         LoadedTilefile* loadedFile);
 
+/*
+ * Attempts to load a save game file the same way load_game does but reports
+ * problems with the file instead of ending the game. Nothing is left 
+ * allocated when the file cannot be loaded.
+ *
+ * fileName: Name of the save game file to be loaded
+ *
+ * state: The current state of the game
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ *
+ * return: Returns SAVE_LOADED if the file has been loaded, SAVE_NO_ACCESS if
+ *         the file cannot be accessed or SAVE_INVALID if the contents of the
+ *         file is not a valid save file.
+ */
+int read_save_file(char* fileName, GameStateInfo* state, 
+        LoadedTilefile* loadedFile);
+
+/*
+ * Reads a save game from an open file. Works the same as read_save_file.
+ *
+ * saveFile: The open file to be read
+ *
+ * state: The current state of the game
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ *
+ * return: Returns SAVE_LOADED if the save has been loaded or SAVE_INVALID if
+ *         the contents of the file is not a valid save file.
+ */
+int read_save(FILE* saveFile, GameStateInfo* state, 
+        LoadedTilefile* loadedFile);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,546 @@
+/*
+ * searchBoard.c
+ * Author: Michael Bossner
+ *
+ * This file contains the compact copy of the board used by the automatic
+ * players that look ahead through the coming tiles.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "searchBoard.h"
+#include "game.h"
+#include "tilefile.h"
+#include "generator.h"
+#include "memStats.h"
+
+#define ZOBRIST_SEED 0x2545F491
+#define FLIP_X 1
+#define FLIP_Y 2
+#define TRANSPOSE 4
+#define TRANSFORMS 8
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Works out the cells of one rotation of a shape.
+ *
+ * setup: The game the shape belongs to
+ *
+ * shape: The shape
+ *
+ * rotation: Rotation of the shape
+ *
+ * cells: Where the cells are returned
+ */
+static void find_rotation_cells(SearchSetup* setup, TileShape* shape,
+        int rotation, RotationCells* cells);
+
+/*
+ * Gets a random 64 bit number.
+ *
+ * random: The generator to be used
+ *
+ * return: Returns the random number
+ */
+static uint64_t random_key(Random* random);
+
+/*
+ * Works out whether every shape can follow a transform of the board and if
+ * so how each rotation of each shape is turned.
+ *
+ * setup: The game. The rotations must already be found
+ *
+ * symmetry: The symmetry with its transform set. The rest is filled in
+ *
+ * return: Returns false if some shape can't follow the transform
+ */
+static bool find_symmetry(SearchSetup* setup, Symmetry* symmetry);
+
+/*
+ * Moves a cell of the board by a transform.
+ *
+ * setup: The game
+ *
+ * transform: The transform
+ *
+ * y: Row of the cell. Updated with the row it is moved to
+ *
+ * x: Column of the cell. Updated with the column it is moved to
+ */
+static void transform_cell(SearchSetup* setup, int transform, int* y,
+        int* x);
+
+/*
+ * Turns the offset of a cell from the centre of a tile by a transform.
+ *
+ * transform: The transform
+ *
+ * y: Row offset. Updated with the turned offset
+ *
+ * x: Column offset. Updated with the turned offset
+ */
+static void transform_offset(int transform, int* y, int* x);
+
+/*
+ * Adds to the counts of the counted shapes for each of their placements
+ * over a cell that fits.
+ *
+ * board: The search board
+ *
+ * cell: Index of the cell
+ *
+ * change: What is added for each placement. 1 or -1
+ */
+static void update_fit_counts(SearchBoard* board, int cell, int change);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+SearchSetup* create_search_setup(GameStateInfo* state) {
+    LoadedTilefile* tiles = state->tiles;
+    SearchSetup* setup = mem_malloc(MEM_AUTO_PLAYER, sizeof(SearchSetup));
+    setup->tiles = tiles;
+    setup->height = state->height;
+    setup->width = state->width;
+    int cellCount = state->height * state->width;
+    setup->cellKeys = mem_malloc(MEM_AUTO_PLAYER, sizeof(uint64_t) * cellCount);
+    setup->tileKeys = mem_malloc(MEM_AUTO_PLAYER,
+            sizeof(uint64_t) * (tiles->size + 1));
+    Random random;
+    seed_random(&random, ZOBRIST_SEED);
+    for (int i = 0; i < cellCount; i++) {
+        setup->cellKeys[i] = random_key(&random);
+    }
+    for (int i = 0; i <= tiles->size; i++) {
+        setup->tileKeys[i] = random_key(&random);
+    }
+    setup->rotations = mem_malloc(MEM_AUTO_PLAYER,
+            sizeof(RotationCells) * tiles->shapeCount * ROTATIONS);
+    for (int shape = 0; shape < tiles->shapeCount; shape++) {
+        for (int r = 0; r < ROTATIONS; r++) {
+            find_rotation_cells(setup, &tiles->shapes[shape], r,
+                    &setup->rotations[shape * ROTATIONS + r]);
+        }
+    }
+    setup->symmetryCount = 0;
+    for (int transform = 0; transform < TRANSFORMS; transform++) {
+        Symmetry* symmetry = &setup->symmetries[setup->symmetryCount];
+        symmetry->transform = transform;
+        // turning the board a quarter only keeps it the same if it is square
+        if ((transform & TRANSPOSE && setup->height != setup->width) ||
+                !find_symmetry(setup, symmetry)) {
+            continue;
+        }
+        if (transform == IDENTITY) {
+            symmetry->cellKeys = setup->cellKeys;
+        } else {
+            symmetry->cellKeys = mem_malloc(MEM_AUTO_PLAYER,
+                    sizeof(uint64_t) * cellCount);
+            for (int i = 0; i < cellCount; i++) {
+                int y = i / setup->width;
+                int x = i % setup->width;
+                transform_cell(setup, transform, &y, &x);
+                symmetry->cellKeys[i] = setup->cellKeys[y * setup->width + x];
+            }
+        }
+        setup->symmetryCount++;
+    }
+    for (int i = 0; i < setup->symmetryCount; i++) {
+        // the transform that puts an offset back where it was
+        int y = 1;
+        int x = 2;
+        transform_offset(setup->symmetries[i].transform, &y, &x);
+        for (int j = 0; j < setup->symmetryCount; j++) {
+            int backY = y;
+            int backX = x;
+            transform_offset(setup->symmetries[j].transform, &backY, &backX);
+            if (backY == 1 && backX == 2) {
+                setup->symmetries[i].inverse = j;
+            }
+        }
+    }
+    return setup;
+}
+
+void free_search_setup(SearchSetup* setup) {
+    for (int i = 0; i < setup->symmetryCount; i++) {
+        if (setup->symmetries[i].transform != IDENTITY) {
+            mem_free(MEM_AUTO_PLAYER, setup->symmetries[i].cellKeys);
+        }
+        mem_free(MEM_AUTO_PLAYER, setup->symmetries[i].rotations);
+        mem_free(MEM_AUTO_PLAYER, setup->symmetries[i].shiftY);
+        mem_free(MEM_AUTO_PLAYER, setup->symmetries[i].shiftX);
+    }
+    mem_free(MEM_AUTO_PLAYER, setup->cellKeys);
+    mem_free(MEM_AUTO_PLAYER, setup->tileKeys);
+    mem_free(MEM_AUTO_PLAYER, setup->rotations);
+    mem_free(MEM_AUTO_PLAYER, setup);
+}
+
+void init_search_board(SearchBoard* board, SearchSetup* setup) {
+    board->setup = setup;
+    board->cells = mem_malloc(MEM_AUTO_PLAYER,
+            sizeof(char) * setup->height * setup->width);
+    memset(board->hashes, 0, sizeof(board->hashes));
+    board->fitCounts = mem_malloc(MEM_AUTO_PLAYER,
+            sizeof(int) * setup->tiles->shapeCount);
+    for (int shape = 0; shape < setup->tiles->shapeCount; shape++) {
+        board->fitCounts[shape] = UNCOUNTED;
+    }
+}
+
+void free_search_board(SearchBoard* board) {
+    mem_free(MEM_AUTO_PLAYER, board->cells);
+    mem_free(MEM_AUTO_PLAYER, board->fitCounts);
+    board->cells = NULL;
+    board->fitCounts = NULL;
+}
+
+void load_search_board(SearchBoard* board, GameStateInfo* state) {
+    memset(board->hashes, 0, sizeof(board->hashes));
+    for (int shape = 0; shape < board->setup->tiles->shapeCount; shape++) {
+        board->fitCounts[shape] = UNCOUNTED;
+    }
+    for (int colm = 0; colm < state->height; colm++) {
+        for (int row = 0; row < state->width; row++) {
+            int cell = colm * state->width + row;
+            board->cells[cell] = 0;
+            if (state->board[colm][row] == PLAYER_1 ||
+                    state->board[colm][row] == PLAYER_2) {
+                set_search_cell(board, cell, 1);
+            }
+        }
+    }
+}
+
+void copy_search_board(SearchBoard* to, SearchBoard* from) {
+    memcpy(to->cells, from->cells, from->setup->height * from->setup->width);
+    memcpy(to->hashes, from->hashes, sizeof(to->hashes));
+    memcpy(to->fitCounts, from->fitCounts,
+            sizeof(int) * from->setup->tiles->shapeCount);
+}
+
+RotationCells* get_rotation_cells(SearchSetup* setup, int tileIndex,
+        int rotation) {
+    return &setup->rotations[setup->tiles->tileShape[tileIndex] * ROTATIONS +
+            rotation];
+}
+
+bool fits_at(SearchBoard* board, RotationCells* cells, int count, int base) {
+    for (int cell = 0; cell < count; cell++) {
+        if (board->cells[base + cells->offsets[cell]]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void set_search_cell(SearchBoard* board, int cell, char filled) {
+    SearchSetup* setup = board->setup;
+    // the placements over the cell fit while it is empty
+    if (filled) {
+        update_fit_counts(board, cell, -1);
+    }
+    board->cells[cell] = filled;
+    if (!filled) {
+        update_fit_counts(board, cell, 1);
+    }
+    for (int i = 0; i < setup->symmetryCount; i++) {
+        board->hashes[i] ^= setup->symmetries[i].cellKeys[cell];
+    }
+}
+
+void set_placement(SearchBoard* board, int tileIndex, Placement* move,
+        char filled) {
+    RotationCells* cells = get_rotation_cells(board->setup, tileIndex,
+            move->rotation);
+    int count = get_tile_shape(board->setup->tiles, tileIndex)->cellCount;
+    int base = move->colm * board->setup->width + move->row;
+    for (int cell = 0; cell < count; cell++) {
+        set_search_cell(board, base + cells->offsets[cell], filled);
+    }
+}
+
+int count_fits(SearchBoard* board, int tileIndex) {
+    SearchSetup* setup = board->setup;
+    int* fitCount = &board->fitCounts[setup->tiles->tileShape[tileIndex]];
+    if (*fitCount != UNCOUNTED) {
+        return *fitCount;
+    }
+    TileShape* shape = get_tile_shape(setup->tiles, tileIndex);
+    int count = 0;
+    for (int r = 0; r < shape->distinct; r++) {
+        RotationCells* cells = get_rotation_cells(setup, tileIndex, r);
+        for (int colm = -cells->minY; colm < setup->height - cells->maxY;
+                colm++) {
+            for (int row = -cells->minX; row < setup->width - cells->maxX;
+                    row++) {
+                if (fits_at(board, cells, shape->cellCount,
+                        colm * setup->width + row)) {
+                    count++;
+                }
+            }
+        }
+    }
+    *fitCount = count;
+    return count;
+}
+
+int find_overlaps(SearchSetup* setup, int mine, int theirs,
+        Overlap overlaps[ROTATIONS][MAX_OVERLAPS], int counts[ROTATIONS]) {
+    TileShape* myShape = &setup->tiles->shapes[mine];
+    TileShape* theirShape = &setup->tiles->shapes[theirs];
+    char seen[ROTATIONS][REACH_SIZE][REACH_SIZE];
+    int most = 0;
+    for (int r = 0; r < myShape->distinct; r++) {
+        memset(seen, 0, sizeof(seen));
+        counts[r] = 0;
+        for (int cell = 0; cell < myShape->cellCount; cell++) {
+            for (int t = 0; t < theirShape->distinct; t++) {
+                for (int i = 0; i < theirShape->cellCount; i++) {
+                    // where their centre is from the centre of the move
+                    int y = myShape->cellY[r][cell] - theirShape->cellY[t][i];
+                    int x = myShape->cellX[r][cell] - theirShape->cellX[t][i];
+                    if (seen[t][y + MAX_REACH][x + MAX_REACH]) {
+                        continue;
+                    }
+                    seen[t][y + MAX_REACH][x + MAX_REACH] = 1;
+                    Overlap* overlap = &overlaps[r][counts[r]++];
+                    overlap->y = y;
+                    overlap->x = x;
+                    overlap->rotation = t;
+                }
+            }
+        }
+        if (counts[r] > most) {
+            most = counts[r];
+        }
+    }
+    return most;
+}
+
+int count_overlapped(SearchBoard* board, int tileIndex, Placement* move,
+        Overlap* overlaps, int count) {
+    SearchSetup* setup = board->setup;
+    int cellCount = get_tile_shape(setup->tiles, tileIndex)->cellCount;
+    int overlapped = 0;
+    for (int i = 0; i < count; i++) {
+        RotationCells* cells = get_rotation_cells(setup, tileIndex,
+                overlaps[i].rotation);
+        int colm = move->colm + overlaps[i].y;
+        int row = move->row + overlaps[i].x;
+        if (on_board(setup, cells, colm, row) && fits_at(board, cells,
+                cellCount, colm * setup->width + row)) {
+            overlapped++;
+        }
+    }
+    return overlapped;
+}
+
+bool on_board(SearchSetup* setup, RotationCells* cells, int colm, int row) {
+    return colm >= -cells->minY && colm < setup->height - cells->maxY &&
+            row >= -cells->minX && row < setup->width - cells->maxX;
+}
+
+uint64_t position_key(SearchBoard* board, int tileIndex) {
+    return board->hashes[IDENTITY] ^ board->setup->tileKeys[tileIndex];
+}
+
+uint64_t canonical_key(SearchBoard* board, int tileIndex, int* symmetry) {
+    // every position a symmetry reaches has the same hashes in some order
+    int least = IDENTITY;
+    for (int i = 1; i < board->setup->symmetryCount; i++) {
+        if (board->hashes[i] < board->hashes[least]) {
+            least = i;
+        }
+    }
+    *symmetry = least;
+    return board->hashes[least] ^ board->setup->tileKeys[tileIndex];
+}
+
+void map_placement(SearchSetup* setup, int tileIndex, Placement* move,
+        int symmetry, Placement* moved) {
+    Symmetry* turn = &setup->symmetries[symmetry];
+    int index = setup->tiles->tileShape[tileIndex] * ROTATIONS +
+            move->rotation;
+    int y = move->colm;
+    int x = move->row;
+    transform_cell(setup, turn->transform, &y, &x);
+    moved->colm = y - turn->shiftY[index];
+    moved->row = x - turn->shiftX[index];
+    moved->rotation = turn->rotations[index];
+    moved->score = move->score;
+}
+
+int pack_move(SearchSetup* setup, Placement* move) {
+    int rowCount = setup->width - 2 * MIN_MOVE;
+    return ((move->colm - MIN_MOVE) * rowCount + (move->row - MIN_MOVE)) *
+            ROTATIONS + move->rotation;
+}
+
+void unpack_move(SearchSetup* setup, int packed, Placement* move) {
+    int rowCount = setup->width - 2 * MIN_MOVE;
+    move->rotation = packed % ROTATIONS;
+    move->row = packed / ROTATIONS % rowCount + MIN_MOVE;
+    move->colm = packed / ROTATIONS / rowCount + MIN_MOVE;
+    move->score = 0;
+}
+
+int next_tile(LoadedTilefile* tiles, int tileIndex) {
+    return tileIndex >= tiles->size ? 0 : tileIndex + 1;
+}
+
+void placement_to_inst(SearchSetup* setup, int tileIndex, Placement* move,
+        int* inst) {
+    inst[COLM] = move->colm;
+    inst[ROW] = move->row;
+    // the tile may be stored at a different rotation to its shape
+    inst[ROTATE] = (move->rotation - setup->tiles->tileRotation[tileIndex] +
+            ROTATIONS) % ROTATIONS * ROTATE_90;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void find_rotation_cells(SearchSetup* setup, TileShape* shape,
+        int rotation, RotationCells* cells) {
+    cells->minY = 0;
+    cells->maxY = 0;
+    cells->minX = 0;
+    cells->maxX = 0;
+    for (int cell = 0; cell < shape->cellCount; cell++) {
+        int y = shape->cellY[rotation][cell];
+        int x = shape->cellX[rotation][cell];
+        cells->offsets[cell] = y * setup->width + x;
+        if (cell == 0 || y < cells->minY) {
+            cells->minY = y;
+        }
+        if (cell == 0 || y > cells->maxY) {
+            cells->maxY = y;
+        }
+        if (cell == 0 || x < cells->minX) {
+            cells->minX = x;
+        }
+        if (cell == 0 || x > cells->maxX) {
+            cells->maxX = x;
+        }
+    }
+}
+
+//
+static uint64_t random_key(Random* random) {
+    uint64_t high = next_random(random);
+    return high << 32 | next_random(random);
+}
+
+//
+static bool find_symmetry(SearchSetup* setup, Symmetry* symmetry) {
+    LoadedTilefile* tiles = setup->tiles;
+    int count = tiles->shapeCount * ROTATIONS;
+    symmetry->rotations = mem_malloc(MEM_AUTO_PLAYER, sizeof(int) * count);
+    symmetry->shiftY = mem_malloc(MEM_AUTO_PLAYER, sizeof(int) * count);
+    symmetry->shiftX = mem_malloc(MEM_AUTO_PLAYER, sizeof(int) * count);
+    for (int shape = 0; shape < tiles->shapeCount; shape++) {
+        TileShape* tileShape = &tiles->shapes[shape];
+        int cells = tileShape->cellCount;
+        for (int r = 0; r < ROTATIONS; r++) {
+            int index = shape * ROTATIONS + r;
+            int turnedY[TILE_CELLS];
+            int turnedX[TILE_CELLS];
+            int first = 0;
+            for (int i = 0; i < cells; i++) {
+                turnedY[i] = tileShape->cellY[r][i];
+                turnedX[i] = tileShape->cellX[r][i];
+                transform_offset(symmetry->transform, &turnedY[i],
+                        &turnedX[i]);
+                if (turnedY[i] < turnedY[first] || (turnedY[i] ==
+                        turnedY[first] && turnedX[i] < turnedX[first])) {
+                    first = i;
+                }
+            }
+            // cells are listed in reading order so the first cells line up
+            bool found = false;
+            for (int to = 0; to < tileShape->distinct && !found; to++) {
+                int shiftY = tileShape->cellY[to][0] - turnedY[first];
+                int shiftX = tileShape->cellX[to][0] - turnedX[first];
+                found = true;
+                for (int i = 0; i < cells && found; i++) {
+                    found = false;
+                    for (int j = 0; j < cells && !found; j++) {
+                        found = tileShape->cellY[to][j] ==
+                                turnedY[i] + shiftY &&
+                                tileShape->cellX[to][j] ==
+                                turnedX[i] + shiftX;
+                    }
+                }
+                symmetry->rotations[index] = to;
+                symmetry->shiftY[index] = shiftY;
+                symmetry->shiftX[index] = shiftX;
+            }
+            if (!found) {
+                mem_free(MEM_AUTO_PLAYER, symmetry->rotations);
+                mem_free(MEM_AUTO_PLAYER, symmetry->shiftY);
+                mem_free(MEM_AUTO_PLAYER, symmetry->shiftX);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//
+static void transform_cell(SearchSetup* setup, int transform, int* y,
+        int* x) {
+    if (transform & TRANSPOSE) {
+        int swap = *y;
+        *y = *x;
+        *x = swap;
+    }
+    if (transform & FLIP_Y) {
+        *y = setup->height - 1 - *y;
+    }
+    if (transform & FLIP_X) {
+        *x = setup->width - 1 - *x;
+    }
+}
+
+//
+static void transform_offset(int transform, int* y, int* x) {
+    if (transform & TRANSPOSE) {
+        int swap = *y;
+        *y = *x;
+        *x = swap;
+    }
+    if (transform & FLIP_Y) {
+        *y = -*y;
+    }
+    if (transform & FLIP_X) {
+        *x = -*x;
+    }
+}
+
+//
+static void update_fit_counts(SearchBoard* board, int cell, int change) {
+    SearchSetup* setup = board->setup;
+    int y = cell / setup->width;
+    int x = cell % setup->width;
+    for (int shape = 0; shape < setup->tiles->shapeCount; shape++) {
+        if (board->fitCounts[shape] == UNCOUNTED) {
+            continue;
+        }
+        TileShape* tileShape = &setup->tiles->shapes[shape];
+        for (int r = 0; r < tileShape->distinct; r++) {
+            RotationCells* cells = &setup->rotations[shape * ROTATIONS + r];
+            // every placement with one of its cells on this cell
+            for (int i = 0; i < tileShape->cellCount; i++) {
+                int colm = y - tileShape->cellY[r][i];
+                int row = x - tileShape->cellX[r][i];
+                if (on_board(setup, cells, colm, row) && fits_at(board,
+                        cells, tileShape->cellCount,
+                        colm * setup->width + row)) {
+                    board->fitCounts[shape] += change;
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,377 @@
+/*
+ * searchBoard.h
+ * Author: Michael Bossner
+ *
+ * Header file for searchBoard.c
+ */
+
+#ifndef SEARCH_BOARD_H
+#define SEARCH_BOARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game.h"
+#include "tilefile.h"
+
+#define NO_MOVE -1
+#define MAX_SYMMETRIES 8
+#define IDENTITY 0
+#define UNCOUNTED -1
+#define MAX_REACH 4
+#define REACH_SIZE (2 * MAX_REACH + 1)
+#define MAX_OVERLAPS (ROTATIONS * REACH_SIZE * REACH_SIZE)
+
+typedef struct RotationCells RotationCells;
+typedef struct Symmetry Symmetry;
+typedef struct SearchSetup SearchSetup;
+typedef struct SearchBoard SearchBoard;
+typedef struct Placement Placement;
+typedef struct Overlap Overlap;
+
+/*
+ * The cells of one rotation of a shape as offsets into the board
+ */
+struct RotationCells {
+    int offsets[TILE_CELLS]; // Offset of each cell from the centre
+    int minY; // Smallest row offset of a cell
+    int maxY; // Largest row offset of a cell
+    int minX; // Smallest column offset of a cell
+    int maxX; // Largest column offset of a cell
+};
+
+/*
+ * A way of turning or flipping the board that every tile can follow, so a
+ * position and the position it is turned into play out the same way
+ */
+struct Symmetry {
+    int transform; // TRANSPOSE, FLIP_Y and FLIP_X bits, done in that order
+    int inverse; // Index of the symmetry that undoes this one
+    uint64_t* cellKeys; // Zobrist key of the cell each cell is moved to
+    /* For each rotation of each shape, the rotation it is turned into and
+       how far the centre of the tile moves from where the centre is moved */
+    int* rotations, * shiftY, * shiftX;
+};
+
+/*
+ * Everything about a game that searches read but never change. Can be
+ * shared by searches on many threads.
+ */
+struct SearchSetup {
+    LoadedTilefile* tiles; // The tiles of the game
+    int height; // Height of the board
+    int width; // Width of the board
+    uint64_t* cellKeys; // Zobrist key of each filled cell
+    uint64_t* tileKeys; // Zobrist key of each tile index
+    RotationCells* rotations; // Cells of every rotation of every shape
+    /* Symmetries of the board the tiles can follow. IDENTITY is first */
+    Symmetry symmetries[MAX_SYMMETRIES];
+    int symmetryCount; // Number of symmetries. 1 when there are no others
+};
+
+/*
+ * A copy of the board that a search fills and empties as it looks ahead
+ */
+struct SearchBoard {
+    SearchSetup* setup; // The game the board belongs to
+    char* cells; // Whether each cell of the board is filled
+    /* Zobrist hash of the filled cells once moved by each symmetry */
+    uint64_t hashes[MAX_SYMMETRIES];
+    /* Placements of each shape that fit. UNCOUNTED until count_fits is
+       first asked for the shape, after which each cell filled or emptied
+       only looks at the placements over it */
+    int* fitCounts;
+};
+
+/*
+ * A placement of the current tile on a search board
+ */
+struct Placement {
+    int colm; // Board row of the centre of the tile
+    int row; // Board column of the centre of the tile
+    int rotation; // Rotation of the shape, not of the tile
+    int score; // Used by searches to order placements
+};
+
+/*
+ * Where a placement of one shape is from a placement of another that it
+ * shares a cell with
+ */
+struct Overlap {
+    int y; // Rows from the centre of the placement overlapped
+    int x; // Columns from the centre of the placement overlapped
+    int rotation; // Rotation of the shape
+};
+
+/*
+ * Creates the search setup for a game. The Zobrist keys are the same every
+ * game so that searches can be repeated. A square board has 8 symmetries
+ * and any other board 4, but the flips are only kept when the mirror image
+ * of every shape is one of its rotations.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns the new setup
+ */
+SearchSetup* create_search_setup(GameStateInfo* state);
+
+/*
+ * Frees a setup created by create_search_setup.
+ *
+ * setup: The setup to be freed
+ */
+void free_search_setup(SearchSetup* setup);
+
+/*
+ * Creates the cells of a search board. The cells are not set and no shape
+ * is counted.
+ *
+ * board: The board to be created
+ *
+ * setup: The game the board belongs to
+ */
+void init_search_board(SearchBoard* board, SearchSetup* setup);
+
+/*
+ * Frees the cells and counts of a search board.
+ *
+ * board: The board to be freed
+ */
+void free_search_board(SearchBoard* board);
+
+/*
+ * Copies the game board into a search board and hashes it. No shape is
+ * counted afterwards.
+ *
+ * board: The search board
+ *
+ * state: The current state of the game
+ */
+void load_search_board(SearchBoard* board, GameStateInfo* state);
+
+/*
+ * Copies one search board over another of the same game.
+ *
+ * to: The board copied to
+ *
+ * from: The board copied from
+ */
+void copy_search_board(SearchBoard* to, SearchBoard* from);
+
+/*
+ * Gets the cells of a rotation of the shape of a tile.
+ *
+ * setup: The game the tile belongs to
+ *
+ * tileIndex: Index of the tile
+ *
+ * rotation: Rotation of the shape
+ *
+ * return: Returns the cells
+ */
+RotationCells* get_rotation_cells(SearchSetup* setup, int tileIndex,
+        int rotation);
+
+/*
+ * Checks whether a rotation of a shape fits at a position of a search
+ * board. The position must keep the shape inside the board.
+ *
+ * board: The search board
+ *
+ * cells: The rotation of the shape
+ *
+ * count: Number of cells in the shape
+ *
+ * base: Index of the board cell under the centre of the shape
+ *
+ * return: Returns true if every cell is empty
+ */
+bool fits_at(SearchBoard* board, RotationCells* cells, int count, int base);
+
+/*
+ * Fills or empties a cell and updates the hashes and the counted shapes.
+ * The cell must be changing.
+ *
+ * board: The search board
+ *
+ * cell: Index of the cell
+ *
+ * filled: Whether the cell is filled or emptied
+ */
+void set_search_cell(SearchBoard* board, int cell, char filled);
+
+/*
+ * Fills or empties the cells of a placement and updates the hashes and the
+ * counted shapes.
+ *
+ * board: The search board
+ *
+ * tileIndex: Index of the tile placed
+ *
+ * move: The placement
+ *
+ * filled: Whether the cells are filled or emptied
+ */
+void set_placement(SearchBoard* board, int tileIndex, Placement* move,
+        char filled);
+
+/*
+ * Counts the placements of a tile on a search board. Rotations that give
+ * the same cells as an earlier rotation are only counted once. The first
+ * count of a shape looks at the whole board and the count is kept up to
+ * date from then on.
+ *
+ * board: The search board
+ *
+ * tileIndex: Index of the tile
+ *
+ * return: Returns the number of placements
+ */
+int count_fits(SearchBoard* board, int tileIndex);
+
+/*
+ * Finds every placement of one shape that shares a cell with a placement
+ * of another. Each is only found once however many cells are shared.
+ *
+ * setup: The game the shapes belong to
+ *
+ * mine: Index of the shape placed
+ *
+ * theirs: Index of the shape overlapped
+ *
+ * overlaps: Where the placements for each rotation of mine are returned
+ *
+ * counts: Where the number of placements for each rotation is returned
+ *
+ * return: Returns the most placements any rotation overlaps
+ */
+int find_overlaps(SearchSetup* setup, int mine, int theirs,
+        Overlap overlaps[ROTATIONS][MAX_OVERLAPS], int counts[ROTATIONS]);
+
+/*
+ * Counts the placements of a tile that fit and share a cell with a move.
+ * Making the move takes away exactly these placements.
+ *
+ * board: The search board. The move must fit on it
+ *
+ * tileIndex: Index of the tile
+ *
+ * move: The move
+ *
+ * overlaps: What find_overlaps found for the rotation of the move
+ *
+ * count: Number of overlaps
+ *
+ * return: Returns the number of placements
+ */
+int count_overlapped(SearchBoard* board, int tileIndex, Placement* move,
+        Overlap* overlaps, int count);
+
+/*
+ * Gets whether every cell of a placement is on the board.
+ *
+ * setup: The game
+ *
+ * cells: The rotation of the shape
+ *
+ * colm: Board row of the centre
+ *
+ * row: Board column of the centre
+ *
+ * return: Returns true if every cell is on the board
+ */
+bool on_board(SearchSetup* setup, RotationCells* cells, int colm, int row);
+
+/*
+ * Gets the Zobrist key of a position.
+ *
+ * board: The search board
+ *
+ * tileIndex: Index of the tile to be placed next
+ *
+ * return: Returns the key
+ */
+uint64_t position_key(SearchBoard* board, int tileIndex);
+
+/*
+ * Gets a Zobrist key that is the same for a position and every position a
+ * symmetry of the board turns it into. Whatever is worked out for the
+ * position holds for all of them once its moves are turned the same way.
+ *
+ * board: The search board
+ *
+ * tileIndex: Index of the tile to be placed next
+ *
+ * symmetry: Where the index of the symmetry that turns the position into
+ *         the one the key is for is returned
+ *
+ * return: Returns the key
+ */
+uint64_t canonical_key(SearchBoard* board, int tileIndex, int* symmetry);
+
+/*
+ * Turns a placement by a symmetry of the board. The cells of the placement
+ * returned are the cells of the placement given once moved by the symmetry
+ * and its rotation is one of the distinct rotations of the shape.
+ *
+ * setup: The game the placement belongs to
+ *
+ * tileIndex: Index of the tile placed
+ *
+ * move: The placement
+ *
+ * symmetry: Index of the symmetry
+ *
+ * moved: Where the turned placement is returned
+ */
+void map_placement(SearchSetup* setup, int tileIndex, Placement* move,
+        int symmetry, Placement* moved);
+
+/*
+ * Packs a placement into a single number.
+ *
+ * setup: The game the placement belongs to
+ *
+ * move: The placement
+ *
+ * return: Returns the packed placement. Never NO_MOVE
+ */
+int pack_move(SearchSetup* setup, Placement* move);
+
+/*
+ * Unpacks a placement packed by pack_move.
+ *
+ * setup: The game the placement belongs to
+ *
+ * packed: The packed placement
+ *
+ * move: Where the placement is returned
+ */
+void unpack_move(SearchSetup* setup, int packed, Placement* move);
+
+/*
+ * Gets the next tile index after a tile.
+ *
+ * tiles: The tiles of the game
+ *
+ * tileIndex: Index of the tile
+ *
+ * return: Returns the index of the following tile
+ */
+int next_tile(LoadedTilefile* tiles, int tileIndex);
+
+/*
+ * Converts a placement into move instructions for the game.
+ *
+ * setup: The game the placement belongs to
+ *
+ * tileIndex: Index of the tile placed
+ *
+ * move: The placement
+ *
+ * inst: Where the move instructions are returned
+ */
+void placement_to_inst(SearchSetup* setup, int tileIndex, Placement* move,
+        int* inst);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,559 @@
+/*
+ * searchPlayer.c
+ * Author: Michael Bossner
+ *
+ * This file contains the automatic player that searches ahead through the
+ * coming tiles with alpha-beta pruning before choosing a move.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "searchPlayer.h"
+#include "game.h"
+#include "tilefile.h"
+#include "searchBoard.h"
+#include "transTable.h"
+#include "options.h"
+#include "threadPool.h"
+#include "book.h"
+#include "endgame.h"
+#include "error.h"
+#include "memStats.h"
+
+#define SEARCH_USAGE "fitz [--depth depth] [--beam width] " \
+        "[--search-threads threads] [--playouts playouts] [--mcts-time ms] " \
+        "[--mcts-seed seed] [--endgame cells] [--book book] [--ponder] " \
+        "[--move-time ms] [--game-time ms] [--search-stats] tilefile ..."
+#define WIN_BOUND (WIN_SCORE - MAX_DEPTH - 1)
+#define TABLE_MOVE_SCORE -1
+#define NANOSECONDS 1e9
+#define SECOND_NS 1000000000LL
+#define MILLISECOND_NS 1000000LL
+#define PERCENT 100.0
+
+static SearchOptions options = {DEFAULT_DEPTH, DEFAULT_BEAM, 0, DEFAULT_PLAYOUTS,
+        DEFAULT_MCTS_TIME, 0, 0, 0, 0, false, false};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Scores a position without searching further.
+ *
+ * worker: The worker searching. Its board holds the position
+ *
+ * tileIndex: Index of the tile the player to move places
+ *
+ * ply: How many moves from the root the position is
+ *
+ * return: Returns the placements of the player to move less those of the
+ *         opponent for the tile after, or a loss if there are none
+ */
+static int evaluate(SearchWorker* worker, int tileIndex, int ply);
+
+/*
+ * Adds a move to a beam sorted by score if it is good enough.
+ *
+ * beam: The moves kept so far
+ *
+ * count: How many moves are in the beam
+ *
+ * move: The move to be added
+ *
+ * return: Returns the new number of moves in the beam
+ */
+static int add_to_beam(Placement* beam, int count, Placement* move);
+
+/*
+ * Gets whether a search has been told to end early.
+ *
+ * worker: The worker searching
+ *
+ * return: Returns true if worker->stop has been set
+ */
+static bool is_stopped(SearchWorker* worker);
+
+/*
+ * Ends a search once its deadline has passed.
+ *
+ * worker: The worker searching
+ *
+ * return: Returns true if worker->stop has been set
+ */
+static bool is_out_of_time(SearchWorker* worker);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+int parse_search_options(int argc, char** argv) {
+    int arg = 1;
+    while (arg < argc) {
+        if (is_option(argc, argv, arg, "--depth")) {
+            if (!parse_int(argv[arg + 1], &options.depth) ||
+                    options.depth <= 0 || options.depth > MAX_DEPTH) {
+                error_usage(SEARCH_USAGE);
+            }
+            arg += 2;
+        } else if (is_option(argc, argv, arg, "--beam")) {
+            if (!parse_int(argv[arg + 1], &options.beam) ||
+                    options.beam <= 0 || options.beam > MAX_BEAM) {
+                error_usage(SEARCH_USAGE);
+            }
+            arg += 2;
+        } else if (is_option(argc, argv, arg, "--search-threads")) {
+            if (!parse_int(argv[arg + 1], &options.threads) ||
+                    options.threads <= 0 || options.threads > MAX_THREADS) {
+                error_usage(SEARCH_USAGE);
+            }
+            arg += 2;
+        } else if (is_option(argc, argv, arg, "--playouts")) {
+            if (!parse_int(argv[arg + 1], &options.playouts) ||
+                    options.playouts <= 0) {
+                error_usage(SEARCH_USAGE);
+            }
+            arg += 2;
+        } else if (is_option(argc, argv, arg, "--mcts-time")) {
+            // 0 leaves only the playout limit
+            if (!parse_int(argv[arg + 1], &options.mctsTime) ||
+                    options.mctsTime < 0) {
+                error_usage(SEARCH_USAGE);
+            }
+            arg += 2;
+        } else if (is_option(argc, argv, arg, "--mcts-seed")) {
+            if (!parse_ulong(argv[arg + 1], &options.mctsSeed)) {
+                error_usage(SEARCH_USAGE);
+            }
+            arg += 2;
+        } else if (is_option(argc, argv, arg, "--endgame")) {
+            // 0 never solves. The solver keeps the moves of every ply
+            if (!parse_int(argv[arg + 1], &options.endgame) ||
+                    options.endgame < 0 ||
+                    options.endgame > MAX_ENDGAME) {
+                error_usage(SEARCH_USAGE);
+            }
+            arg += 2;
+        } else if (is_option(argc, argv, arg, "--book")) {
+            if (!open_book(argv[arg + 1])) {
+                fprintf(stderr, "Can't read opening book %s\n", argv[arg + 1]);
+                error_usage(SEARCH_USAGE);
+            }
+            arg += 2;
+        } else if (is_option(argc, argv, arg, "--move-time")) {
+            // 0 for no limit
+            if (!parse_int(argv[arg + 1], &options.moveTime) ||
+                    options.moveTime < 0) {
+                error_usage(SEARCH_USAGE);
+            }
+            arg += 2;
+        } else if (is_option(argc, argv, arg, "--game-time")) {
+            // 0 for no limit
+            if (!parse_int(argv[arg + 1], &options.gameTime) ||
+                    options.gameTime < 0) {
+                error_usage(SEARCH_USAGE);
+            }
+            arg += 2;
+        } else if (strcmp(argv[arg], "--ponder") == 0) {
+            options.ponder = true;
+            arg++;
+        } else if (strcmp(argv[arg], "--search-stats") == 0) {
+            options.stats = true;
+            arg++;
+        } else {
+            break;
+        }
+    }
+    return arg - 1;
+}
+
+SearchOptions* get_search_options(void) {
+    return &options;
+}
+
+int search_thread_count(void) {
+    int threads = options.threads;
+    if (threads == 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    return threads > MAX_THREADS ? MAX_THREADS : threads;
+}
+
+bool search_move(GameStateInfo* state) {
+    int64_t start = search_clock();
+    Search* search = get_search(state, 1);
+    if (search->table == NULL) {
+        search->table = create_trans_table(SEARCH_TABLE_BITS);
+    }
+    SearchWorker* worker = &search->workers[0];
+    worker->table = search->table;
+    worker->repeatable = false;
+    worker->nodes = 0;
+    worker->probes = 0;
+    worker->hits = 0;
+    load_search_board(&worker->board, state);
+    int stop = 0;
+    worker->deadline = move_deadline(state, start);
+    worker->stop = worker->deadline == NO_DEADLINE ? NULL : &stop;
+
+    // without a deadline only the one depth is searched
+    int depth = worker->deadline == NO_DEADLINE ? options.depth : 1;
+    int maxDepth = worker->deadline == NO_DEADLINE ? options.depth :
+            MAX_DEPTH;
+    int reached = 0;
+    Placement best = worker->best;
+    for (; depth <= maxDepth; depth++) {
+        int score = search_position(worker, state->tileIndex, depth,
+                -INFINITE_SCORE, INFINITE_SCORE, 0);
+        if (stop) {
+            break;
+        }
+        best = worker->best;
+        reached = depth;
+        if (!search_deeper(score, start, worker->deadline)) {
+            break;
+        }
+    }
+
+    worker->stop = NULL;
+    worker->deadline = NO_DEADLINE;
+    int64_t end = search_clock();
+    search->spent[state->turn] += end - start;
+    if (reached > 0) {
+        placement_to_inst(search->setup, state->tileIndex, &best,
+                state->inst);
+    }
+    print_search_stats(state, worker, 1, reached,
+            (double)(end - start) / SECOND_NS);
+    return reached > 0;
+}
+
+int64_t search_clock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * SECOND_NS + now.tv_nsec;
+}
+
+int64_t move_deadline(GameStateInfo* state, int64_t start) {
+    if (options.moveTime == 0 && options.gameTime == 0) {
+        return NO_DEADLINE;
+    }
+    Search* search = get_search(state, 1);
+    if (search->deadlineMove == state->moveCount) {
+        return search->deadline;
+    }
+    int64_t budget = options.moveTime * MILLISECOND_NS;
+    if (options.gameTime != 0) {
+        int64_t left = options.gameTime * MILLISECOND_NS -
+                search->spent[state->turn];
+        // both players fill the free cells so this many moves at most
+        int cells = get_tile_shape(state->tiles, state->tileIndex)->cellCount;
+        int moves = count_free_cells(state) / (2 * cells) + 1;
+        int64_t share = left > 0 ? left / moves : 0;
+        if (options.moveTime == 0 || share < budget) {
+            budget = share;
+        }
+    }
+    search->deadlineMove = state->moveCount;
+    search->deadline = start + budget;
+    return search->deadline;
+}
+
+bool search_deeper(int score, int64_t start, int64_t deadline) {
+    if (score > WIN_BOUND || score < -WIN_BOUND) {
+        return false;
+    }
+    // the next depth takes longer than every depth before it
+    return deadline == NO_DEADLINE || search_clock() - start <
+            (deadline - start) / 2;
+}
+
+Search* get_search(GameStateInfo* state, int workers) {
+    Search* search = state->search;
+    if (search == NULL) {
+        search = mem_malloc(MEM_AUTO_PLAYER, sizeof(Search));
+        search->setup = create_search_setup(state);
+        search->table = NULL;
+        search->sharedTable = NULL;
+        search->workers = NULL;
+        search->workerCount = 0;
+        search->mobility = NULL;
+        search->mcts = NULL;
+        search->solved = NULL;
+        search->ponder = NULL;
+        search->pool = NULL;
+        search->deadlineMove = -1;
+        search->spent[P1] = 0;
+        search->spent[P2] = 0;
+        state->search = search;
+    }
+    if (search->workerCount < workers) {
+        search->workers = mem_realloc(MEM_AUTO_PLAYER, search->workers,
+                sizeof(SearchWorker) * workers);
+        for (int i = search->workerCount; i < workers; i++) {
+            init_search_board(&search->workers[i].board, search->setup);
+            search->workers[i].stop = NULL;
+            search->workers[i].deadline = NO_DEADLINE;
+        }
+        search->workerCount = workers;
+    }
+    return search;
+}
+
+int search_position(SearchWorker* worker, int tileIndex, int depth,
+        int alpha, int beta, int ply) {
+    if (is_stopped(worker)) {
+        return 0;
+    }
+    worker->nodes++;
+    if (is_out_of_time(worker)) {
+        return 0;
+    }
+    SearchSetup* setup = worker->board.setup;
+    // the order of equal moves in a beam is not the same in a mirror image
+    // so repeatable searches keep every position apart
+    int symmetry = IDENTITY;
+    uint64_t key = worker->repeatable ?
+            position_key(&worker->board, tileIndex) :
+            canonical_key(&worker->board, tileIndex, &symmetry);
+    TableEntry entry;
+    int tableMove = NO_MOVE;
+    worker->probes++;
+    if (probe_table(worker->table, key, &entry)) {
+        worker->hits++;
+        if (!worker->repeatable && entry.move != NO_MOVE) {
+            // the move was stored as it is in the canonical position
+            Placement move;
+            unpack_move(setup, entry.move, &move);
+            map_placement(setup, tileIndex, &move,
+                    setup->symmetries[symmetry].inverse, &move);
+            tableMove = pack_move(setup, &move);
+        }
+        // wins are stored relative to the position rather than the root
+        int score = entry.score;
+        if (score > WIN_BOUND) {
+            score -= ply;
+        } else if (score < -WIN_BOUND) {
+            score += ply;
+        }
+        // a deeper result can differ from searching again at this depth
+        bool deepEnough = worker->repeatable ? entry.depth == depth :
+                entry.depth >= depth;
+        // the root always searches so that it has a move to play
+        if (ply > 0 && deepEnough && (entry.bound == BOUND_EXACT ||
+                (entry.bound == BOUND_LOWER && score >= beta) ||
+                (entry.bound == BOUND_UPPER && score <= alpha))) {
+            return score;
+        }
+    }
+
+    int best;
+    entry.move = NO_MOVE;
+    entry.bound = BOUND_EXACT;
+    Placement* beam = worker->beams[ply];
+    int count = depth == 0 ? 0 :
+            collect_moves(worker, tileIndex, tableMove, beam);
+    if (depth == 0) {
+        best = evaluate(worker, tileIndex, ply);
+    } else if (count == 0) {
+        // the player to move has lost
+        best = -(WIN_SCORE - ply);
+    } else {
+        int alphaStart = alpha;
+        int next = next_tile(setup->tiles, tileIndex);
+        best = -INFINITE_SCORE;
+        for (int i = 0; i < count; i++) {
+            set_placement(&worker->board, tileIndex, &beam[i], 1);
+            int score = -search_position(worker, next, depth - 1, -beta,
+                    -alpha, ply + 1);
+            set_placement(&worker->board, tileIndex, &beam[i], 0);
+            if (is_stopped(worker)) {
+                // the score is unfinished so none of this can be kept
+                return 0;
+            }
+            if (score > best) {
+                best = score;
+                Placement move;
+                map_placement(setup, tileIndex, &beam[i], symmetry, &move);
+                entry.move = pack_move(setup, &move);
+                if (ply == 0) {
+                    worker->best = beam[i];
+                }
+            }
+            if (best > alpha) {
+                alpha = best;
+            }
+            if (alpha >= beta) {
+                break;
+            }
+        }
+        if (best <= alphaStart) {
+            entry.bound = BOUND_UPPER;
+        } else if (best >= beta) {
+            entry.bound = BOUND_LOWER;
+        }
+    }
+
+    entry.score = best;
+    if (best > WIN_BOUND) {
+        entry.score += ply;
+    } else if (best < -WIN_BOUND) {
+        entry.score -= ply;
+    }
+    entry.depth = depth;
+    store_table(worker->table, key, &entry);
+    return best;
+}
+
+int collect_moves(SearchWorker* worker, int tileIndex, int tableMove,
+        Placement* beam) {
+    SearchBoard* board = &worker->board;
+    SearchSetup* setup = board->setup;
+    TileShape* shape = get_tile_shape(setup->tiles, tileIndex);
+    int next = next_tile(setup->tiles, tileIndex);
+    // a move leaves the opponent every placement it does not overlap
+    Overlap overlaps[ROTATIONS][MAX_OVERLAPS];
+    int overlapCounts[ROTATIONS];
+    find_overlaps(setup, setup->tiles->tileShape[tileIndex],
+            setup->tiles->tileShape[next], overlaps, overlapCounts);
+    int theirs = count_fits(board, next);
+    int count = 0;
+    Placement move;
+    // rotations that repeat an earlier one give the same moves
+    for (move.rotation = 0; move.rotation < shape->distinct;
+            move.rotation++) {
+        RotationCells* cells = get_rotation_cells(setup, tileIndex,
+                move.rotation);
+        for (move.colm = -cells->minY;
+                move.colm < setup->height - cells->maxY; move.colm++) {
+            for (move.row = -cells->minX;
+                    move.row < setup->width - cells->maxX; move.row++) {
+                if (!fits_at(board, cells, shape->cellCount,
+                        move.colm * setup->width + move.row)) {
+                    continue;
+                }
+                // a large board has many moves to score
+                if (is_out_of_time(worker)) {
+                    return count;
+                }
+                if (tableMove != NO_MOVE &&
+                        pack_move(setup, &move) == tableMove) {
+                    move.score = TABLE_MOVE_SCORE;
+                } else {
+                    move.score = theirs - count_overlapped(board, next, &move,
+                            overlaps[move.rotation],
+                            overlapCounts[move.rotation]);
+                }
+                count = add_to_beam(beam, count, &move);
+            }
+        }
+    }
+    return count;
+}
+
+void print_search_stats(GameStateInfo* state, SearchWorker* workers,
+        int workerCount, int depth, double seconds) {
+    if (!options.stats) {
+        return;
+    }
+    unsigned long nodes = 0;
+    unsigned long probes = 0;
+    unsigned long hits = 0;
+    for (int i = 0; i < workerCount; i++) {
+        nodes += workers[i].nodes;
+        probes += workers[i].probes;
+        hits += workers[i].hits;
+    }
+    fprintf(stderr, "Player %c search: depth %d, threads %d, nodes %lu, "
+            "%.0f nodes/s, table hits %.1f%%\n", state->player,
+            depth, workerCount, nodes,
+            seconds > 0 ? nodes / seconds : 0.0,
+            probes ? PERCENT * hits / probes : 0.0);
+}
+
+void free_search(GameStateInfo* state) {
+    Search* search = state->search;
+    if (search == NULL) {
+        return;
+    }
+    // a thread still pondering uses everything else
+    if (search->ponder != NULL) {
+        free_ponder(search->ponder);
+    }
+    for (int i = 0; i < search->workerCount; i++) {
+        free_search_board(&search->workers[i].board);
+    }
+    mem_free(MEM_AUTO_PLAYER, search->workers);
+    if (search->table != NULL) {
+        free_trans_table(search->table);
+    }
+    if (search->sharedTable != NULL) {
+        free_trans_table(search->sharedTable);
+    }
+    if (search->mobility != NULL) {
+        free_mobility_map(search->mobility);
+    }
+    if (search->mcts != NULL) {
+        free_mcts_trees(search->mcts);
+    }
+    if (search->solved != NULL) {
+        free_trans_table(search->solved);
+    }
+    if (search->pool != NULL) {
+        free_thread_pool(search->pool);
+    }
+    free_search_setup(search->setup);
+    mem_free(MEM_AUTO_PLAYER, search);
+    state->search = NULL;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int evaluate(SearchWorker* worker, int tileIndex, int ply) {
+    int mine = count_fits(&worker->board, tileIndex);
+    if (mine == 0) {
+        return -(WIN_SCORE - ply);
+    }
+    return mine - count_fits(&worker->board,
+            next_tile(worker->board.setup->tiles, tileIndex));
+}
+
+//
+static int add_to_beam(Placement* beam, int count, Placement* move) {
+    // moves with equal scores stay in the order they were found
+    int place = count;
+    while (place > 0 && beam[place - 1].score > move->score) {
+        place--;
+    }
+    if (place >= options.beam) {
+        return count;
+    }
+    if (count == options.beam) {
+        count--;
+    }
+    memmove(&beam[place + 1], &beam[place],
+            sizeof(Placement) * (count - place));
+    beam[place] = *move;
+    return count + 1;
+}
+
+//
+static bool is_stopped(SearchWorker* worker) {
+    return worker->stop != NULL &&
+            __atomic_load_n(worker->stop, __ATOMIC_RELAXED);
+}
+
+//
+static bool is_out_of_time(SearchWorker* worker) {
+    if (worker->deadline != NO_DEADLINE &&
+            search_clock() >= worker->deadline) {
+        __atomic_store_n(worker->stop, 1, __ATOMIC_RELAXED);
+    }
+    return is_stopped(worker);
+}
\ No newline at end of file
@@ -0,0 +1,251 @@
+/*
+ * searchPlayer.h
+ * Author: Michael Bossner
+ *
+ * Header file for searchPlayer.c
+ */
+
+#ifndef SEARCH_PLAYER_H
+#define SEARCH_PLAYER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game.h"
+#include "searchBoard.h"
+#include "transTable.h"
+#include "mobilityPlayer.h"
+#include "mctsPlayer.h"
+#include "ponder.h"
+#include "threadPool.h"
+
+#define APT3 '3'
+#define DEFAULT_DEPTH 3
+#define DEFAULT_BEAM 8
+#define MAX_DEPTH 32
+#define MAX_BEAM 64
+#define DEFAULT_PLAYOUTS 5000
+#define DEFAULT_MCTS_TIME 1000
+#define SEARCH_TABLE_BITS 16
+#define NO_DEADLINE 0
+#define WIN_SCORE 1000000
+#define INFINITE_SCORE (WIN_SCORE + 1)
+
+typedef struct SearchOptions SearchOptions;
+typedef struct SearchWorker SearchWorker;
+
+/*
+ * How the search players look ahead. Shared by every game in the process
+ */
+struct SearchOptions {
+    int depth; // How many moves ahead are searched
+    int beam; // How many of the best looking moves are searched at each turn
+    int threads; // Threads used by the parallel players. 0 for all
+    int playouts; // Most random games the Monte Carlo player plays a move
+    int mctsTime; // Most milliseconds the Monte Carlo player takes a move
+    unsigned long mctsSeed; // Seed of the random games
+    int endgame; // Free cells at which the game is solved exactly. 0 never
+    int moveTime; // Most milliseconds a search player takes a move. 0 for any
+    int gameTime; // Most milliseconds a search player takes a game. 0 for any
+    bool ponder; // Search the replies to likely moves while a human thinks
+    bool stats; // Print the speed of each search to stderr
+};
+
+/*
+ * One thread of a search
+ */
+struct SearchWorker {
+    SearchBoard board; // The board as the search looks ahead
+    TransTable* table; // Positions already searched. May be shared
+    /* Only use table entries that give the same result as searching again
+       and do not let the table change which moves are searched */
+    bool repeatable;
+    Placement beams[MAX_DEPTH + 1][MAX_BEAM]; // Moves searched at each ply
+    Placement best; // Best move found at the root
+    int* stop; // Set by another thread to end the search early. May be NULL
+    int64_t deadline; // search_clock at which stop is set. NO_DEADLINE if none
+    unsigned long nodes; // Positions searched
+    unsigned long probes; // Table lookups
+    unsigned long hits; // Table lookups that found the position
+};
+
+/*
+ * Everything the search players keep for a game
+ */
+struct Search {
+    SearchSetup* setup; // What the searches of the game share
+    TransTable* table; // Positions searched by the search player
+    TransTable* sharedTable; // Positions searched by the parallel player
+    SearchWorker* workers; // One per thread
+    int workerCount; // Number of workers
+    MobilityMap* mobility; // Placements kept by the mobility player
+    MctsTrees* mcts; // Trees and buffers kept by the Monte Carlo player
+    TransTable* solved; // Positions solved by the endgame solver
+    Ponder* ponder; // Replies searched while a human thinks
+    ThreadPool* pool; // Threads of the parallel and Monte Carlo players
+    int deadlineMove; // moveCount the deadline was worked out for
+    int64_t deadline; // search_clock by which that move must be chosen
+    int64_t spent[P2 + 1]; // Nanoseconds each player has searched for
+};
+
+/*
+ * Reads the search options from the start of the command line arguments.
+ * fitz [--depth depth] [--beam width] [--search-threads threads]
+ *         [--playouts playouts] [--mcts-time ms] [--mcts-seed seed]
+ *         [--endgame cells] [--book book] [--ponder] [--move-time ms]
+ *         [--game-time ms] [--search-stats] ...
+ *
+ * argc: Number of command line arguments
+ *
+ * argv: The command line arguments
+ *
+ * return: Returns how many arguments were search options
+ *
+ * error_usage: A search option has an invalid value or the opening book
+ *         can't be read. Program ends.
+ */
+int parse_search_options(int argc, char** argv);
+
+/*
+ * Gets the search options given on the command line.
+ *
+ * return: Returns the options
+ */
+SearchOptions* get_search_options(void);
+
+/*
+ * Gets the number of threads the parallel players search with.
+ *
+ * return: Returns --search-threads or else the number of processors
+ */
+int search_thread_count(void);
+
+/*
+ * Chooses a move for the current player with a depth limited alpha-beta
+ * search through the coming tiles. Positions are scored by how many
+ * placements each player has for their next tile and positions already
+ * searched are looked up in a transposition table kept for the game. With
+ * --move-time or --game-time the search deepens one move at a time until
+ * the time for the move is up and the move of the deepest search finished
+ * is chosen.
+ * Updates state->inst with the move chosen.
+ *
+ * state: The current state of the game. There must be a valid move
+ *
+ * return: Returns false if the time ran out before any search finished
+ */
+bool search_move(GameStateInfo* state);
+
+/*
+ * Gets the time of the monotonic clock.
+ *
+ * return: Returns the time in nanoseconds
+ */
+int64_t search_clock(void);
+
+/*
+ * Works out when the current player must have chosen their move by. Each
+ * move gets --move-time and an even share of what is left of --game-time
+ * over the moves the player may still make, whichever is less. Later calls
+ * for the same move, such as a search after the endgame solver gave up,
+ * get the same deadline.
+ *
+ * state: The current state of the game
+ *
+ * start: search_clock when the move was started
+ *
+ * return: Returns the search_clock of the deadline or NO_DEADLINE if there
+ *         are no time limits
+ */
+int64_t move_deadline(GameStateInfo* state, int64_t start);
+
+/*
+ * Gets whether iterative deepening should search one move deeper. Once the
+ * result is certain or half the time is gone another depth is not started.
+ *
+ * score: Score of the depth just finished
+ *
+ * start: search_clock when the move was started
+ *
+ * deadline: The deadline of the move
+ *
+ * return: Returns true if another depth should be searched
+ */
+bool search_deeper(int score, int64_t start, int64_t deadline);
+
+/*
+ * Gets the search storage for a game, creating it with at least a number of
+ * workers if needed.
+ *
+ * state: The current state of the game
+ *
+ * workers: How many workers are needed
+ *
+ * return: Returns the search storage
+ */
+Search* get_search(GameStateInfo* state, int workers);
+
+/*
+ * Searches a position with negamax and alpha-beta pruning.
+ *
+ * worker: The worker searching. Its board holds the position
+ *
+ * tileIndex: Index of the tile the player to move places
+ *
+ * depth: How many more moves to search
+ *
+ * alpha: Lowest score the player to move is already sure of
+ *
+ * beta: Highest score the opponent will allow
+ *
+ * ply: How many moves from the root the position is
+ *
+ * return: Returns the score of the position for the player to move. Has no
+ *         meaning once worker->stop is set, which is done at
+ *         worker->deadline
+ */
+int search_position(SearchWorker* worker, int tileIndex, int depth,
+        int alpha, int beta, int ply);
+
+/*
+ * Finds the best looking moves for a tile. Moves are ordered by how few
+ * placements they leave the opponent.
+ *
+ * worker: The worker searching. Its board holds the position
+ *
+ * tileIndex: Index of the tile to be placed
+ *
+ * tableMove: A move to be searched first or NO_MOVE
+ *
+ * beam: Where the moves are returned. Holds the beam width of moves
+ *
+ * return: Returns how many moves were returned. 0 if there are none. Not
+ *         every move is looked at once worker->stop is set
+ */
+int collect_moves(SearchWorker* worker, int tileIndex, int tableMove,
+        Placement* beam);
+
+/*
+ * Prints the speed of a search to stderr when --search-stats is given.
+ *
+ * state: The current state of the game
+ *
+ * workers: The workers of the search
+ *
+ * workerCount: Number of workers
+ *
+ * depth: Depth of the deepest search finished. 0 if none was
+ *
+ * seconds: How long the search took
+ */
+void print_search_stats(GameStateInfo* state, SearchWorker* workers,
+        int workerCount, int depth, double seconds);
+
+/*
+ * Frees everything the search players created for a game.
+ *
+ * state: The current state of the game
+ */
+void free_search(GameStateInfo* state);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,174 @@
+/*
+ * selfplay.c
+ * Author: Michael Bossner
+ *
+ * This file contains functions for playing many automatic player games at
+ * once in a single process.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "selfplay.h"
+#include "game.h"
+#include "tilefile.h"
+#include "autoPlayer.h"
+#include "generator.h"
+#include "threadPool.h"
+#include "options.h"
+#include "error.h"
+#include "memStats.h"
+
+#define ARGV_GAMES 2
+#define POSITIONAL_ARGS 5
+#define POS_TILEFILE 0
+#define POS_P1_TYPE 1
+#define POS_P2_TYPE 2
+#define POS_HEIGHT 3
+#define POS_WIDTH 4
+#define NS_PER_SEC 1000000000.0
+#define USAGE "fitz --selfplay games [--threads threads] tilefile p1type " \
+        "p2type height width"
+
+typedef struct SelfplayRun SelfplayRun;
+
+/*
+ * Everything shared by the games of a selfplay run. The tiles are only ever
+ * read so they are shared by every thread.
+ */
+struct SelfplayRun {
+    LoadedTilefile tiles; // Tiles used by every game
+    char p1Type; // Player 1s type
+    char p2Type; // Player 2s type
+    int height; // Height of every board
+    int width; // Width of every board
+    int* turns; // Number of turns each game lasted
+    char* winners; // The winner of each game
+};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Plays a single game of the run without printing anything.
+ *
+ * index: Number of the game
+ *
+ * run: The SelfplayRun the game belongs to
+ */
+static void play_game(int index, void* run);
+
+/*
+ * Prints the combined results of every game in a run.
+ *
+ * run: The finished run
+ *
+ * games: How many games were played
+ *
+ * seconds: How long the run took
+ */
+static void print_results(SelfplayRun* run, int games, double seconds);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+int selfplay_main(int argc, char** argv) {
+    SelfplayRun run;
+    int games;
+    int threads = 1;
+    int arg = ARGV_GAMES + 1;
+    if (argc <= ARGV_GAMES || !parse_int(argv[ARGV_GAMES], &games) || 
+            games <= 0) {
+        error_usage(USAGE);
+    }
+    if (arg < argc && is_option(argc, argv, arg, "--threads")) {
+        if (!parse_int(argv[arg + 1], &threads) || threads <= 0) {
+            error_usage(USAGE);
+        }
+        arg += 2;
+    }
+    if (argc - arg != POSITIONAL_ARGS) {
+        error_usage(USAGE);
+    }
+    char** pos = &argv[arg];
+    if (strlen(pos[POS_P1_TYPE]) != 1 || strlen(pos[POS_P2_TYPE]) != 1 ||
+            !is_auto_player(pos[POS_P1_TYPE][0]) || 
+            !is_auto_player(pos[POS_P2_TYPE][0])) {
+        error_4();
+    }
+    run.p1Type = pos[POS_P1_TYPE][0];
+    run.p2Type = pos[POS_P2_TYPE][0];
+    if (!parse_int(pos[POS_HEIGHT], &run.height) || 
+            !parse_int(pos[POS_WIDTH], &run.width) || run.height <= 0 || 
+            run.width <= 0 || run.height > MAX_BOARD_SIZE || 
+            run.width > MAX_BOARD_SIZE) {
+        error_5();
+    }
+    run.tiles.tilefileName = pos[POS_TILEFILE];
+    load_tile_source(&run.tiles);
+    run.turns = mem_malloc(MEM_BATCH, sizeof(int) * games);
+    run.winners = mem_malloc(MEM_BATCH, sizeof(char) * games);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    run_jobs(games, threads, play_game, &run);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    print_results(&run, games, (end.tv_sec - start.tv_sec) + 
+            (end.tv_nsec - start.tv_nsec) / NS_PER_SEC);
+
+    mem_free(MEM_BATCH, run.turns);
+    mem_free(MEM_BATCH, run.winners);
+    free_loaded_tiles(&run.tiles);
+    return EXIT;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void play_game(int index, void* run) {
+    SelfplayRun* selfplay = run;
+    GameStateInfo state;
+    state.p1Type = selfplay->p1Type;
+    state.p2Type = selfplay->p2Type;
+    state.height = selfplay->height;
+    state.width = selfplay->width;
+    prepare_game(&state, &selfplay->tiles, NEW_GAME);
+    // start each game on a different tile
+    state.tileIndex = index % (selfplay->tiles.size + 1);
+    state.tile = selfplay->tiles.loadedTiles[state.tileIndex];
+    state.quiet = true;
+    int turns = 0;
+    while (!play_turn(&state)) {
+        turns++;
+    }
+    selfplay->turns[index] = turns;
+    selfplay->winners[index] = state.player;
+    end_game(&state);
+}
+
+//
+static void print_results(SelfplayRun* run, int games, double seconds) {
+    int p1Wins = 0;
+    long totalTurns = 0;
+    int minTurns = run->turns[0];
+    int maxTurns = run->turns[0];
+    for (int i = 0; i < games; i++) {
+        if (run->winners[i] == PLAYER_1) {
+            p1Wins++;
+        }
+        totalTurns += run->turns[i];
+        if (run->turns[i] < minTurns) {
+            minTurns = run->turns[i];
+        }
+        if (run->turns[i] > maxTurns) {
+            maxTurns = run->turns[i];
+        }
+    }
+    printf("Games: %d\n", games);
+    printf("Player %c wins: %d\n", PLAYER_1, p1Wins);
+    printf("Player %c wins: %d\n", PLAYER_2, games - p1Wins);
+    printf("Game length: min %d, mean %.2f, max %d turns\n", minTurns, 
+            (double)totalTurns / games, maxTurns);
+    printf("Games per second: %.2f\n", games / seconds);
+}
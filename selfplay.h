@@ -0,0 +1,34 @@
+/*
+ * selfplay.h
+ * Author: Michael Bossner
+ *
+ * Header file for selfplay.c
+ */
+
+#ifndef SELFPLAY_H
+#define SELFPLAY_H
+
+#define SELFPLAY "--selfplay"
+
+/*
+ * Plays many automatic player games at once on a pool of threads and prints
+ * the combined results. Nothing is printed during the games.
+ * fitz --selfplay games [--threads threads] tilefile p1type p2type 
+ *         height width
+ * Game n starts on tile n so that the games differ from each other.
+ *
+ * argc: Number of command line arguments
+ *
+ * argv: The command line arguments
+ *
+ * return: Returns 0 when completed
+ *
+ * error_usage: The arguments are invalid. Program ends.
+ *
+ * error_4: A player type is not an automatic player. Program ends.
+ *
+ * error_5: The board dimensions are invalid. Program ends.
+ */
+int selfplay_main(int argc, char** argv);
+
+#endif
@@ -0,0 +1,848 @@
+/*
+ * server.c
+ * Author: Michael Bossner
+ *
+ * This file contains a server that hosts many games at once over a Unix
+ * domain socket. A single thread waits on every connection with epoll and
+ * automatic player turns are run on a pool of worker threads.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "server.h"
+#include "fitz.h"
+#include "game.h"
+#include "saveGame.h"
+#include "threadPool.h"
+#include "options.h"
+#include "error.h"
+#include "memStats.h"
+
+#define USAGE "fitz --serve socket [--threads threads] tilefile"
+#define DEFAULT_THREADS 4
+#define SOCKET_FAILED 1
+#define MAX_EVENTS 64
+#define MAX_LINE 256
+#define MAX_WORDS 6
+#define READ_SIZE 4096
+#define SEPARATORS " \t\r"
+#define NEW_WORDS 5
+#define LOAD_WORDS 4
+#define MOVE_WORDS 3
+#define SAVE_COMMAND "save"
+
+typedef struct Client Client;
+typedef struct Server Server;
+
+/*
+ * A single connection and the game it is playing
+ */
+struct Client {
+    int fd; // The connection. -1 once it has been closed
+    char in[MAX_LINE]; // Input that has not been run yet
+    int inLength; // Number of bytes in in
+    char* out; // Output that has not been sent yet
+    size_t outLength; // Number of bytes in out
+    size_t outSent; // Number of bytes of out already sent
+    size_t outSize; // Number of bytes allocated for out
+    FitzGame* game; // The game being played. NULL before one is started
+    bool busy; // A worker owns the game
+    char* reply; // Output of the worker for the game
+    size_t replyLength; // Number of bytes in reply
+    Client* next; // Next client in the work, done or closed queue
+    Client* prev; // Previous client in the list of all clients
+    Client* after; // Next client in the list of all clients
+};
+
+/*
+ * Everything shared by the event loop and the workers
+ */
+struct Server {
+    FitzTiles* tiles; // Tiles shared by every game
+    int listenFd; // Socket new connections arrive on
+    int wakeFd; // Signalled by a worker when a game is done
+    int epollFd; // Waits on every socket and wakeFd
+    Client* clients; // Every open client
+    pthread_mutex_t lock; // Protects the work and done queues and stopping
+    pthread_cond_t work; // Signalled when work is queued or on stopping
+    Client* workHead; // Clients waiting for a worker
+    Client* workTail; // Last client waiting for a worker
+    Client* done; // Clients a worker has finished with
+    Client* closed; // Closed clients to be freed after the current events
+    bool stopping; // The workers should return
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Opens the listening socket.
+ *
+ * path: Name of the socket
+ *
+ * return: Returns the socket or -1 if it can't be opened
+ */
+static int open_socket(char* path);
+
+/*
+ * Waits for events and handles them until a stop is requested.
+ *
+ * server: The running server
+ */
+static void event_loop(Server* server);
+
+/*
+ * Accepts every waiting connection.
+ *
+ * server: The running server
+ */
+static void accept_clients(Server* server);
+
+/*
+ * Reads from a client and runs each complete line.
+ *
+ * server: The running server
+ *
+ * client: The client that is readable
+ */
+static void read_client(Server* server, Client* client);
+
+/*
+ * Runs each complete line of input while the client is not busy.
+ *
+ * server: The running server
+ *
+ * client: The client whose input is run
+ */
+static void run_lines(Server* server, Client* client);
+
+/*
+ * Runs a single command from a client.
+ *
+ * server: The running server
+ *
+ * client: The client that sent the command
+ *
+ * line: The command. Modified while split into words
+ *
+ * return: Returns false if the client should be closed
+ */
+static bool run_command(Server* server, Client* client, char* line);
+
+/*
+ * Starts a new game or loads a saved game for a client.
+ *
+ * server: The running server
+ *
+ * client: The client starting the game
+ *
+ * words: The words of the command
+ *
+ * wordCount: Number of words in the command
+ */
+static void start_game(Server* server, Client* client, char** words,
+        int wordCount);
+
+/*
+ * Plays a move for the human player whose turn it is.
+ *
+ * server: The running server
+ *
+ * client: The client playing the move
+ *
+ * words: The colm, row and rotate of the move
+ */
+static void play_move(Server* server, Client* client, char** words);
+
+/*
+ * Saves a clients game to a file.
+ *
+ * client: The client saving the game
+ *
+ * name: Name of the save file
+ */
+static void save_client_game(Client* client, char* name);
+
+/*
+ * Gets a game in the save format.
+ *
+ * game: The game
+ *
+ * size: Where the size of the save is returned
+ *
+ * return: Returns the save. Must be freed
+ */
+static char* game_text(FitzGame* game, size_t* size);
+
+/*
+ * Reads a whole file into memory.
+ *
+ * name: Name of the file
+ *
+ * size: Where the size of the file is returned
+ *
+ * return: Returns the contents of the file or NULL if it can't be read
+ */
+static char* read_whole_file(char* name, size_t* size);
+
+/*
+ * Hands a clients game to the workers so any automatic player turns are
+ * played and the state of the game is sent back.
+ *
+ * server: The running server
+ *
+ * client: The client whose game is queued
+ */
+static void queue_game(Server* server, Client* client);
+
+/*
+ * Plays queued games until the server is stopping.
+ *
+ * server: The running server
+ *
+ * return: Returns NULL once the server is stopping
+ */
+static void* worker(void* server);
+
+/*
+ * Plays automatic player turns until a human player is to move or the game
+ * is over.
+ *
+ * client: The client whose game is played. Its reply is set
+ */
+static void play_auto_turns(Client* client);
+
+/*
+ * Takes back the games finished by the workers and sends their replies.
+ *
+ * server: The running server
+ */
+static void collect_done(Server* server);
+
+/*
+ * Adds output for a client.
+ *
+ * client: The client the output is for
+ *
+ * data: The output
+ *
+ * length: Number of bytes in data
+ */
+static void add_output(Client* client, const char* data, size_t length);
+
+/*
+ * Adds an error message for a client.
+ *
+ * client: The client the message is for
+ *
+ * message: The message
+ */
+static void add_error(Client* client, const char* message);
+
+/*
+ * Sends as much of a clients output as the socket will take and updates
+ * which events are waited on.
+ *
+ * server: The running server
+ *
+ * client: The client being sent to
+ *
+ * return: Returns false if the connection has failed
+ */
+static bool flush_client(Server* server, Client* client);
+
+/*
+ * Closes a clients connection. The client is freed after the current events
+ * unless a worker owns its game, in which case that is once the worker is
+ * done.
+ *
+ * server: The running server
+ *
+ * client: The client to be closed
+ */
+static void close_client(Server* server, Client* client);
+
+/*
+ * Frees a client and removes it from the list of all clients.
+ *
+ * server: The running server
+ *
+ * client: The client to be freed
+ */
+static void free_client(Server* server, Client* client);
+
+/*
+ * Frees every closed client.
+ *
+ * server: The running server
+ */
+static void free_closed(Server* server);
+
+/*
+ * Records that a stop has been requested.
+ *
+ * number: The signal received
+ */
+static void request_stop(int number);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+int server_main(int argc, char** argv) {
+    Server server;
+    int threads = DEFAULT_THREADS;
+    if (argc < 3) {
+        error_usage(USAGE);
+    }
+    char* path = argv[2];
+    int arg = 3;
+    while (arg < argc && strncmp(argv[arg], "--", 2) == 0) {
+        if (is_option(argc, argv, arg, "--threads")) {
+            if (!parse_int(argv[arg + 1], &threads) || threads <= 0) {
+                error_usage(USAGE);
+            }
+        } else {
+            error_usage(USAGE);
+        }
+        arg += 2;
+    }
+    if (argc - arg != 1) {
+        error_usage(USAGE);
+    }
+    switch (fitz_tiles_load(argv[arg], &server.tiles)) {
+        case FITZ_ERR_ACCESS:
+            error_2();
+
+        case FITZ_ERR_TILES:
+            error_3();
+    }
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+
+    server.listenFd = open_socket(path);
+    if (server.listenFd < 0) {
+        fprintf(stderr, "Can't open socket %s\n", path);
+        fitz_tiles_free(server.tiles);
+        return SOCKET_FAILED;
+    }
+    server.wakeFd = eventfd(0, EFD_NONBLOCK);
+    server.epollFd = epoll_create1(0);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = &server.listenFd;
+    epoll_ctl(server.epollFd, EPOLL_CTL_ADD, server.listenFd, &event);
+    event.data.ptr = &server.wakeFd;
+    epoll_ctl(server.epollFd, EPOLL_CTL_ADD, server.wakeFd, &event);
+    server.clients = NULL;
+    pthread_mutex_init(&server.lock, NULL);
+    pthread_cond_init(&server.work, NULL);
+    server.workHead = NULL;
+    server.workTail = NULL;
+    server.done = NULL;
+    server.closed = NULL;
+    server.stopping = false;
+
+    // no SA_RESTART so epoll_wait returns when a stop is requested
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    pthread_t ids[MAX_THREADS];
+    int started = 0;
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&ids[started], NULL, worker, &server) == 0) {
+            started++;
+        }
+    }
+    event_loop(&server);
+
+    pthread_mutex_lock(&server.lock);
+    server.stopping = true;
+    pthread_cond_broadcast(&server.work);
+    pthread_mutex_unlock(&server.lock);
+    for (int i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    server.closed = NULL;
+    while (server.clients != NULL) {
+        Client* client = server.clients;
+        if (client->fd >= 0) {
+            close(client->fd);
+        }
+        free_client(&server, client);
+    }
+    pthread_cond_destroy(&server.work);
+    pthread_mutex_destroy(&server.lock);
+    close(server.epollFd);
+    close(server.wakeFd);
+    close(server.listenFd);
+    unlink(path);
+    fitz_tiles_free(server.tiles);
+    return EXIT;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static int open_socket(char* path) {
+    struct sockaddr_un address;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    // a socket left behind by an earlier server would stop the bind
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+            listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+//
+static void event_loop(Server* server) {
+    struct epoll_event events[MAX_EVENTS];
+    while (!stopRequested) {
+        int count = epoll_wait(server->epollFd, events, MAX_EVENTS, -1);
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.ptr == &server->listenFd) {
+                accept_clients(server);
+            } else if (events[i].data.ptr == &server->wakeFd) {
+                collect_done(server);
+            } else {
+                Client* client = events[i].data.ptr;
+                if (client->fd < 0) {
+                    // closed by an earlier event in this batch
+                    continue;
+                }
+                if ((events[i].events & EPOLLOUT) &&
+                        !flush_client(server, client)) {
+                    close_client(server, client);
+                } else if (events[i].events & (EPOLLIN | EPOLLERR |
+                        EPOLLHUP)) {
+                    read_client(server, client);
+                }
+            }
+        }
+        free_closed(server);
+    }
+}
+
+//
+static void accept_clients(Server* server) {
+    FOREVER {
+        int fd = accept(server->listenFd, NULL, NULL);
+        if (fd < 0) {
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        Client* client = mem_calloc(MEM_SERVER, 1, sizeof(Client));
+        client->fd = fd;
+        client->after = server->clients;
+        if (server->clients != NULL) {
+            server->clients->prev = client;
+        }
+        server->clients = client;
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = client;
+        epoll_ctl(server->epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+//
+static void read_client(Server* server, Client* client) {
+    if (client->inLength == MAX_LINE) {
+        // input is only waited on while there is room for it
+        close_client(server, client);
+        return;
+    }
+    ssize_t got = read(client->fd, &client->in[client->inLength],
+            MAX_LINE - client->inLength);
+    if (got < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    } else if (got <= 0) {
+        close_client(server, client);
+        return;
+    }
+    client->inLength += got;
+    run_lines(server, client);
+}
+
+//
+static void run_lines(Server* server, Client* client) {
+    while (!client->busy && client->fd >= 0) {
+        char* end = memchr(client->in, '\n', client->inLength);
+        if (end == NULL) {
+            if (client->inLength == MAX_LINE) {
+                add_error(client, "Line too long");
+                flush_client(server, client);
+                close_client(server, client);
+                return;
+            }
+            break;
+        }
+        *end = '\0';
+        char line[MAX_LINE];
+        int length = end - client->in + 1;
+        memcpy(line, client->in, length);
+        client->inLength -= length;
+        memmove(client->in, &client->in[length], client->inLength);
+        if (!run_command(server, client, line)) {
+            flush_client(server, client);
+            close_client(server, client);
+            return;
+        }
+    }
+    if (client->fd >= 0 && !flush_client(server, client)) {
+        close_client(server, client);
+    }
+}
+
+//
+static bool run_command(Server* server, Client* client, char* line) {
+    char* words[MAX_WORDS];
+    int wordCount = 0;
+    char* save;
+    for (char* word = strtok_r(line, SEPARATORS, &save); word != NULL;
+            word = strtok_r(NULL, SEPARATORS, &save)) {
+        if (wordCount == MAX_WORDS) {
+            add_error(client, "Unknown command");
+            return true;
+        }
+        words[wordCount++] = word;
+    }
+    if (wordCount == 0) {
+        return true;
+    } else if (wordCount == 1 && strcmp(words[0], "quit") == 0) {
+        return false;
+    } else if ((wordCount == NEW_WORDS && strcmp(words[0], "new") == 0) ||
+            (wordCount == LOAD_WORDS && strcmp(words[0], "load") == 0)) {
+        start_game(server, client, words, wordCount);
+    } else if (client->game == NULL) {
+        add_error(client, "No game");
+    } else if (wordCount == 1 && strcmp(words[0], "board") == 0) {
+        size_t size;
+        char* text = game_text(client->game, &size);
+        add_output(client, text, size);
+        mem_free(MEM_SERVER, text);
+    } else if (wordCount == 1 && strncmp(words[0], SAVE_COMMAND,
+            SAVE_NAME_START) == 0 && strlen(words[0]) > SAVE_NAME_START) {
+        save_client_game(client, &words[0][SAVE_NAME_START]);
+    } else if (wordCount == MOVE_WORDS) {
+        play_move(server, client, words);
+    } else {
+        add_error(client, "Unknown command");
+    }
+    return true;
+}
+
+//
+static void start_game(Server* server, Client* client, char** words,
+        int wordCount) {
+    if (strlen(words[1]) != 1 || strlen(words[2]) != 1) {
+        add_error(client, fitz_strerror(FITZ_ERR_PLAYER));
+        return;
+    }
+    FitzGame* game;
+    int status;
+    if (wordCount == NEW_WORDS) {
+        int height;
+        int width;
+        if (!parse_int(words[3], &height) || !parse_int(words[4], &width)) {
+            add_error(client, fitz_strerror(FITZ_ERR_DIMENSIONS));
+            return;
+        }
+        status = fitz_game_new(server->tiles, height, width, words[1][0],
+                words[2][0], &game);
+    } else {
+        size_t size;
+        char* data = read_whole_file(words[3], &size);
+        if (data == NULL) {
+            add_error(client, "Can't access save file");
+            return;
+        }
+        status = fitz_game_load(server->tiles, data, size, words[1][0],
+                words[2][0], &game);
+        mem_free(MEM_SERVER, data);
+    }
+    if (status != FITZ_OK) {
+        add_error(client, fitz_strerror(status));
+        return;
+    }
+    if (client->game != NULL) {
+        fitz_game_free(client->game);
+    }
+    client->game = game;
+    queue_game(server, client);
+}
+
+//
+static void play_move(Server* server, Client* client, char** words) {
+    FitzMove move;
+    if (!parse_int(words[COLM], &move.colm) ||
+            !parse_int(words[ROW], &move.row) ||
+            !parse_int(words[ROTATE], &move.rotate)) {
+        add_error(client, fitz_strerror(FITZ_ERR_MOVE));
+        return;
+    }
+    int status = fitz_game_apply(client->game, move);
+    if (status != FITZ_OK) {
+        add_error(client, fitz_strerror(status));
+        return;
+    }
+    queue_game(server, client);
+}
+
+//
+static void save_client_game(Client* client, char* name) {
+    size_t size;
+    char* text = game_text(client->game, &size);
+    FILE* file = fopen(name, "w");
+    if (file == NULL || fwrite(text, 1, size, file) != size) {
+        add_error(client, "Unable to save file");
+    } else {
+        add_output(client, "ok\n", strlen("ok\n"));
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+    mem_free(MEM_SERVER, text);
+}
+
+//
+static char* game_text(FitzGame* game, size_t* size) {
+    // the first call only finds the size
+    fitz_game_save(game, NULL, 0, size);
+    char* text = mem_malloc(MEM_SERVER, *size);
+    fitz_game_save(game, text, *size, size);
+    return text;
+}
+
+//
+static char* read_whole_file(char* name, size_t* size) {
+    FILE* file = fopen(name, "r");
+    if (file == NULL) {
+        return NULL;
+    }
+    char* data = NULL;
+    *size = 0;
+    size_t got;
+    do {
+        data = mem_realloc(MEM_SERVER, data, *size + READ_SIZE);
+        got = fread(&data[*size], 1, READ_SIZE, file);
+        *size += got;
+    } while (got == READ_SIZE);
+    fclose(file);
+    return data;
+}
+
+//
+static void queue_game(Server* server, Client* client) {
+    client->busy = true;
+    client->next = NULL;
+    pthread_mutex_lock(&server->lock);
+    if (server->workTail == NULL) {
+        server->workHead = client;
+    } else {
+        server->workTail->next = client;
+    }
+    server->workTail = client;
+    pthread_cond_signal(&server->work);
+    pthread_mutex_unlock(&server->lock);
+}
+
+//
+static void* worker(void* server) {
+    Server* shared = server;
+    FOREVER {
+        pthread_mutex_lock(&shared->lock);
+        while (shared->workHead == NULL && !shared->stopping) {
+            pthread_cond_wait(&shared->work, &shared->lock);
+        }
+        if (shared->stopping) {
+            pthread_mutex_unlock(&shared->lock);
+            return NULL;
+        }
+        Client* client = shared->workHead;
+        shared->workHead = client->next;
+        if (shared->workHead == NULL) {
+            shared->workTail = NULL;
+        }
+        pthread_mutex_unlock(&shared->lock);
+
+        play_auto_turns(client);
+
+        pthread_mutex_lock(&shared->lock);
+        client->next = shared->done;
+        shared->done = client;
+        pthread_mutex_unlock(&shared->lock);
+        uint64_t one = 1;
+        if (write(shared->wakeFd, &one, sizeof(one)) < 0) {
+            // the counter is already non zero so the loop will wake
+        }
+    }
+}
+
+//
+static void play_auto_turns(Client* client) {
+    FILE* out = open_memstream(&client->reply, &client->replyLength);
+    FitzMove move;
+    char player = fitz_game_player(client->game);
+    while (fitz_game_step(client->game, &move) == FITZ_OK) {
+        fprintf(out, "Player %c => %d %d rotated %d\n", player, move.colm,
+                move.row, move.rotate);
+        player = fitz_game_player(client->game);
+    }
+    if (fitz_game_is_over(client->game)) {
+        fprintf(out, "Player %c wins\n", fitz_game_player(client->game));
+    } else {
+        fprintf(out, "Player %c]\n", fitz_game_player(client->game));
+    }
+    fclose(out);
+}
+
+//
+static void collect_done(Server* server) {
+    uint64_t count;
+    if (read(server->wakeFd, &count, sizeof(count)) < 0) {
+        return;
+    }
+    pthread_mutex_lock(&server->lock);
+    Client* done = server->done;
+    server->done = NULL;
+    pthread_mutex_unlock(&server->lock);
+    while (done != NULL) {
+        Client* client = done;
+        done = done->next;
+        client->busy = false;
+        add_output(client, client->reply, client->replyLength);
+        free(client->reply);
+        client->reply = NULL;
+        if (client->fd < 0) {
+            client->next = server->closed;
+            server->closed = client;
+        } else {
+            // commands that arrived while the workers had the game
+            run_lines(server, client);
+        }
+    }
+}
+
+//
+static void add_output(Client* client, const char* data, size_t length) {
+    if (client->outLength + length > client->outSize) {
+        client->outSize = (client->outLength + length) * 2;
+        client->out = mem_realloc(MEM_SERVER, client->out,
+                client->outSize);
+    }
+    memcpy(&client->out[client->outLength], data, length);
+    client->outLength += length;
+}
+
+//
+static void add_error(Client* client, const char* message) {
+    add_output(client, "err ", strlen("err "));
+    add_output(client, message, strlen(message));
+    add_output(client, "\n", 1);
+}
+
+//
+static bool flush_client(Server* server, Client* client) {
+    while (client->outSent < client->outLength) {
+        ssize_t sent = send(client->fd, &client->out[client->outSent],
+                client->outLength - client->outSent, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        } else if (sent < 0 && errno == EAGAIN) {
+            break;
+        } else if (sent < 0) {
+            return false;
+        }
+        client->outSent += sent;
+    }
+    if (client->outSent == client->outLength) {
+        client->outSent = 0;
+        client->outLength = 0;
+    }
+    // only wait for input while there is room for it
+    struct epoll_event event;
+    event.events = (client->inLength < MAX_LINE ? EPOLLIN : 0) |
+            (client->outLength > 0 ? EPOLLOUT : 0);
+    event.data.ptr = client;
+    epoll_ctl(server->epollFd, EPOLL_CTL_MOD, client->fd, &event);
+    return true;
+}
+
+//
+static void close_client(Server* server, Client* client) {
+    if (client->fd >= 0) {
+        epoll_ctl(server->epollFd, EPOLL_CTL_DEL, client->fd, NULL);
+        close(client->fd);
+        client->fd = -1;
+    }
+    if (!client->busy) {
+        client->next = server->closed;
+        server->closed = client;
+    }
+}
+
+//
+static void free_client(Server* server, Client* client) {
+    if (client->prev == NULL) {
+        server->clients = client->after;
+    } else {
+        client->prev->after = client->after;
+    }
+    if (client->after != NULL) {
+        client->after->prev = client->prev;
+    }
+    if (client->game != NULL) {
+        fitz_game_free(client->game);
+    }
+    // open_memstream allocated the reply itself
+    free(client->reply);
+    mem_free(MEM_SERVER, client->out);
+    mem_free(MEM_SERVER, client);
+}
+
+//
+static void free_closed(Server* server) {
+    while (server->closed != NULL) {
+        Client* client = server->closed;
+        server->closed = client->next;
+        free_client(server, client);
+    }
+}
+
+//
+static void request_stop(int number) {
+    stopRequested = 1;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+/*
+ * server.h
+ * Author: Michael Bossner
+ *
+ * Header file for server.c
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#define SERVE "--serve"
+
+/*
+ * Hosts many games at once over a Unix domain socket.
+ * fitz --serve socket [--threads threads] tilefile
+ * Each connection plays one game at a time by sending lines of text:
+ *     new p1type p2type height width   Starts a new game
+ *     load p1type p2type savefile      Loads a saved game
+ *     colm row rotate                  Plays a move as a human player would
+ *     savefile                         Saves the game as a human player would
+ *     board                            Sends the game in the save format
+ *     quit                             Closes the connection
+ * After a game is started or a move is played any automatic player turns are
+ * run on a pool of threads. Each of their moves is sent as
+ * "Player c => colm row rotated r" followed by either "Player c]" when a
+ * human player is to move or "Player c wins" when the game is over.
+ * Problems are sent as "err message". Runs until SIGINT or SIGTERM.
+ *
+ * argc: Number of command line arguments
+ *
+ * argv: The command line arguments
+ *
+ * return: Returns 0 once the server is stopped.
+ *         Returns 1 if the socket can't be opened.
+ *
+ * error_usage: The arguments are invalid. Program ends.
+ *
+ * error_2: The tilefile can't be accessed. Program ends.
+ *
+ * error_3: The tilefile contents are invalid. Program ends.
+ */
+int server_main(int argc, char** argv);
+
+#endif
@@ -0,0 +1,257 @@
+/*
+ * stats.c
+ * Author: Michael Bossner
+ *
+ * This file contains the timers turned on by --stats. Each run of a phase is
+ * added to a histogram with 16 buckets for every power of 2 nanoseconds, so
+ * a percentile read from it is within 1/16 of the real value and no run has
+ * to be kept. Everything is added to with atomics so games on many threads
+ * can share the totals. With --perf the hardware counters of the thread
+ * are read at the start and end of each run as well.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "stats.h"
+
+#define SUB_BITS 4
+#define SUB_BUCKETS (1 << SUB_BITS)
+#define BUCKETS (64 * SUB_BUCKETS)
+#define SECOND_NS 1000000000LL
+#define MICROSECOND_NS 1e3
+#define MILLISECOND_NS 1e6
+#define MEDIAN 0.5
+#define TAIL 0.99
+
+typedef struct PhaseStats PhaseStats;
+
+/*
+ * Every run of one phase
+ */
+struct PhaseStats {
+    uint64_t count; // Runs of the phase
+    uint64_t totalNs; // Time of every run added up
+    uint64_t maxNs; // Time of the slowest run
+    uint64_t buckets[BUCKETS]; // Runs in each range of times
+    uint64_t counted; // Runs the hardware counters were read for
+    uint64_t counts[PERF_COUNTERS]; // Each hardware counter added up
+};
+
+// Whether the phases are being timed
+static bool enabled = false;
+// Whether the hardware counters are read as well
+static bool perfEnabled = false;
+// The phases in the order of the PHASE_ defines
+static PhaseStats phases[PHASE_COUNT];
+// The counters in the order of the COUNTER_ defines
+static uint64_t counters[COUNTER_COUNT];
+// JSON name of each phase
+static const char* phaseNames[PHASE_COUNT] = {"load_tiles", "game_over",
+        "auto_move", "update_board", "print_board", "save_game",
+        "load_game"};
+// JSON name of each counter
+static const char* counterNames[COUNTER_COUNT] = {"is_move_valid_calls",
+        "cells_inspected"};
+// JSON name of each hardware counter
+static const char* perfNames[PERF_COUNTERS] = {"cycles", "instructions",
+        "l1d_misses", "llc_misses", "branch_misses"};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Prints every phase and counter to stderr as JSON. Registered with atexit.
+ */
+static void print_stats(void);
+
+/*
+ * Prints the hardware counters of a phase as JSON.
+ *
+ * stats: The phase
+ */
+static void print_perf(PhaseStats* stats);
+
+/*
+ * Gets the bucket of a time.
+ *
+ * ns: The time in nanoseconds
+ *
+ * return: Returns the index of the bucket
+ */
+static int bucket_of(uint64_t ns);
+
+/*
+ * Gets the time in the middle of a bucket.
+ *
+ * bucket: Index of the bucket
+ *
+ * return: Returns the time in nanoseconds
+ */
+static double bucket_middle(int bucket);
+
+/*
+ * Reads a percentile from the histogram of a phase.
+ *
+ * stats: The phase
+ *
+ * fraction: The share of runs at or below the percentile. Between 0 and 1
+ *
+ * return: Returns the time in nanoseconds
+ */
+static double percentile(PhaseStats* stats, double fraction);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+void enable_stats(void) {
+    if (!enabled) {
+        enabled = true;
+        atexit(print_stats);
+    }
+}
+
+void enable_perf_stats(void) {
+    enable_stats();
+    if (!perfEnabled && !enable_perf_counters()) {
+        fprintf(stderr, "Hardware counters are not available so only times "
+                "are kept\n");
+        return;
+    }
+    perfEnabled = true;
+}
+
+bool stats_enabled(void) {
+    return enabled;
+}
+
+void start_phase(PhaseStart* start) {
+    start->ns = NO_PHASE_START;
+    if (!enabled) {
+        return;
+    }
+    start->counted = perfEnabled && read_perf_counters(start->counts);
+    // read last so the counters are not part of the time
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    start->ns = now.tv_sec * SECOND_NS + now.tv_nsec;
+}
+
+void end_phase(int phase, PhaseStart* start) {
+    if (start->ns == NO_PHASE_START) {
+        return;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t ns = now.tv_sec * SECOND_NS + now.tv_nsec - start->ns;
+    PhaseStats* stats = &phases[phase];
+    uint64_t counts[PERF_COUNTERS];
+    if (start->counted && read_perf_counters(counts)) {
+        __atomic_fetch_add(&stats->counted, 1, __ATOMIC_RELAXED);
+        for (int i = 0; i < PERF_COUNTERS; i++) {
+            __atomic_fetch_add(&stats->counts[i],
+                    counts[i] - start->counts[i], __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_fetch_add(&stats->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->totalNs, ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->buckets[bucket_of(ns)], 1, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&stats->maxNs, __ATOMIC_RELAXED);
+    while (ns > max && !__atomic_compare_exchange_n(&stats->maxNs, &max, ns,
+            false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // max now holds the time another thread stored
+    }
+}
+
+void count_stat(int counter, long amount) {
+    if (enabled) {
+        __atomic_fetch_add(&counters[counter], amount, __ATOMIC_RELAXED);
+    }
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void print_stats(void) {
+    fprintf(stderr, "{\"phases\": {");
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        PhaseStats* stats = &phases[i];
+        fprintf(stderr, "%s\n  \"%s\": {\"count\": %llu, \"total_ms\": %.3f, "
+                "\"p50_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f",
+                i == 0 ? "" : ",", phaseNames[i],
+                (unsigned long long)stats->count,
+                stats->totalNs / MILLISECOND_NS,
+                percentile(stats, MEDIAN) / MICROSECOND_NS,
+                percentile(stats, TAIL) / MICROSECOND_NS,
+                stats->maxNs / MICROSECOND_NS);
+        if (perfEnabled) {
+            print_perf(stats);
+        }
+        fputc('}', stderr);
+    }
+    fprintf(stderr, "\n}, \"counters\": {");
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        fprintf(stderr, "%s\n  \"%s\": %llu", i == 0 ? "" : ",",
+                counterNames[i], (unsigned long long)counters[i]);
+    }
+    fprintf(stderr, "\n}}\n");
+}
+
+//
+static void print_perf(PhaseStats* stats) {
+    fprintf(stderr, ", \"perf_runs\": %llu",
+            (unsigned long long)stats->counted);
+    for (int i = 0; i < PERF_COUNTERS; i++) {
+        if (perf_counter_available(i)) {
+            fprintf(stderr, ", \"%s\": %llu", perfNames[i],
+                    (unsigned long long)stats->counts[i]);
+        }
+    }
+    if (perf_counter_available(PERF_CYCLES) &&
+            perf_counter_available(PERF_INSTRUCTIONS) &&
+            stats->counts[PERF_CYCLES] > 0) {
+        fprintf(stderr, ", \"ipc\": %.3f",
+                (double)stats->counts[PERF_INSTRUCTIONS] /
+                stats->counts[PERF_CYCLES]);
+    }
+}
+
+//
+static int bucket_of(uint64_t ns) {
+    if (ns < SUB_BUCKETS) {
+        return ns;
+    }
+    // the top SUB_BITS bits below the highest set bit pick the bucket
+    int high = 63 - __builtin_clzll(ns);
+    return (high - SUB_BITS + 1) * SUB_BUCKETS +
+            (int)((ns >> (high - SUB_BITS)) & (SUB_BUCKETS - 1));
+}
+
+//
+static double bucket_middle(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    int high = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    double width = (double)(1ULL << (high - SUB_BITS));
+    return ((double)(1ULL << high) + (bucket % SUB_BUCKETS) * width) +
+            width / 2;
+}
+
+//
+static double percentile(PhaseStats* stats, double fraction) {
+    if (stats->count == 0) {
+        return 0;
+    }
+    // the run the percentile falls on counting from the fastest
+    uint64_t rank = (uint64_t)(fraction * (stats->count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += stats->buckets[bucket];
+        if (seen >= rank) {
+            double middle = bucket_middle(bucket);
+            return middle < stats->maxNs ? middle : stats->maxNs;
+        }
+    }
+    return stats->maxNs;
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+/*
+ * stats.h
+ * Author: Michael Bossner
+ *
+ * Header file for stats.c
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "perfCounters.h"
+
+#define PHASE_LOAD_TILES 0
+#define PHASE_GAME_OVER 1
+#define PHASE_AUTO_MOVE 2
+#define PHASE_UPDATE_BOARD 3
+#define PHASE_PRINT_BOARD 4
+#define PHASE_SAVE_GAME 5
+#define PHASE_LOAD_GAME 6
+#define PHASE_COUNT 7
+#define COUNTER_MOVE_CHECKS 0
+#define COUNTER_CELLS_INSPECTED 1
+#define COUNTER_COUNT 2
+#define NO_PHASE_START 0
+
+typedef struct PhaseStart PhaseStart;
+
+/*
+ * Where one run of a phase started
+ */
+struct PhaseStart {
+    int64_t ns; // When the phase started. NO_PHASE_START when stats are off
+    bool counted; // Whether the hardware counters were read
+    uint64_t counts[PERF_COUNTERS]; // The hardware counters when it started
+};
+
+/*
+ * Turns on the timing of each phase of the game for the rest of the program.
+ * The totals and latency histograms are printed to stderr as JSON when the
+ * program exits.
+ */
+void enable_stats(void);
+
+/*
+ * Turns on the stats along with the hardware counters of each phase. When
+ * the counters are not allowed this is reported and only the times are
+ * kept.
+ */
+void enable_perf_stats(void);
+
+/*
+ * Gets whether the phases of the game are being timed.
+ *
+ * return: Returns true once enable_stats has been called
+ */
+bool stats_enabled(void);
+
+/*
+ * Starts timing one run of a phase.
+ *
+ * start: Where the start of the phase is returned. Its time is
+ *         NO_PHASE_START when stats are off
+ */
+void start_phase(PhaseStart* start);
+
+/*
+ * Adds one run of a phase to its totals and histogram. Must be called on
+ * the thread that started the phase, but any number of threads can.
+ *
+ * phase: The phase. One of the PHASE_ defines
+ *
+ * start: What start_phase returned when the phase started
+ */
+void end_phase(int phase, PhaseStart* start);
+
+/*
+ * Adds to a counter. Safe to call from any thread.
+ *
+ * counter: The counter. One of the COUNTER_ defines
+ *
+ * amount: How much to add
+ */
+void count_stat(int counter, long amount);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,212 @@
+/*
+ * threadPool.c
+ * Author: Michael Bossner
+ *
+ * This file contains a simple pool of threads for running independent jobs.
+ * run_jobs starts its threads for one set of jobs while a ThreadPool keeps
+ * its threads asleep between sets so that a search can hand out jobs many
+ * times a move.
+ */
+
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "threadPool.h"
+#include "memStats.h"
+
+typedef struct JobQueue JobQueue;
+typedef struct PoolThread PoolThread;
+
+/*
+ * Jobs shared between the threads of the pool
+ */
+struct JobQueue {
+    pthread_mutex_t lock; // Protects next
+    int next; // Index of the next job to be started
+    int jobCount; // How many jobs there are
+    void (*job)(int index, void* arg); // Runs a single job
+    void* arg; // Passed to every job
+};
+
+/*
+ * One thread of a ThreadPool
+ */
+struct PoolThread {
+    ThreadPool* pool; // The pool the thread belongs to
+    int id; // Number of the thread. The thread running jobs is 0
+};
+
+/*
+ * Threads kept to run jobs
+ */
+struct ThreadPool {
+    pthread_mutex_t lock; // Protects everything below
+    pthread_cond_t work; // Signalled when jobs are added or the pool closes
+    pthread_cond_t finished; // Signalled when the last job finishes
+    pthread_t ids[MAX_THREADS]; // The threads started
+    PoolThread threads[MAX_THREADS]; // Each thread. Index 0 is the caller
+    int started; // Number of threads started
+    void (*job)(int index, int thread, void* arg); // Runs a single job
+    void* arg; // Passed to every job
+    int next; // Index of the next job to be started
+    int jobCount; // How many jobs there are
+    int done; // How many jobs have finished
+    bool closing; // Whether the threads are to end
+};
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Runs jobs from the queue until there are none left.
+ *
+ * queue: The JobQueue shared by the pool
+ *
+ * return: Returns NULL when there are no jobs left
+ */
+static void* worker(void* queue);
+
+/*
+ * Runs jobs of a pool until they have all been started. The lock of the
+ * pool is held when called and when it returns.
+ *
+ * thread: The PoolThread running the jobs
+ */
+static void take_pool_jobs(PoolThread* thread);
+
+/*
+ * Sleeps until the pool has jobs and runs them until the pool is freed.
+ *
+ * thread: The PoolThread of the thread
+ *
+ * return: Returns NULL once the pool closes
+ */
+static void* pool_worker(void* thread);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+void run_jobs(int jobCount, int threads, void (*job)(int index, void* arg),
+        void* arg) {
+    JobQueue queue;
+    pthread_mutex_init(&queue.lock, NULL);
+    queue.next = 0;
+    queue.jobCount = jobCount;
+    queue.job = job;
+    queue.arg = arg;
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+    if (threads > jobCount) {
+        threads = jobCount;
+    }
+    // the calling thread is one of the workers
+    pthread_t ids[MAX_THREADS];
+    int started = 0;
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&ids[started], NULL, worker, &queue) == 0) {
+            started++;
+        }
+    }
+    worker(&queue);
+    for (int i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    pthread_mutex_destroy(&queue.lock);
+}
+
+ThreadPool* create_thread_pool(int threads) {
+    ThreadPool* pool = mem_malloc(MEM_AUTO_PLAYER, sizeof(ThreadPool));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->finished, NULL);
+    pool->next = 0;
+    pool->jobCount = 0;
+    pool->done = 0;
+    pool->closing = false;
+    pool->started = 0;
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+    pool->threads[0].pool = pool;
+    pool->threads[0].id = 0;
+    for (int i = 1; i < threads; i++) {
+        PoolThread* thread = &pool->threads[pool->started + 1];
+        thread->pool = pool;
+        thread->id = pool->started + 1;
+        if (pthread_create(&pool->ids[pool->started], NULL, pool_worker,
+                thread) == 0) {
+            pool->started++;
+        }
+    }
+    return pool;
+}
+
+void run_pool_jobs(ThreadPool* pool, int jobCount,
+        void (*job)(int index, int thread, void* arg), void* arg) {
+    pthread_mutex_lock(&pool->lock);
+    pool->job = job;
+    pool->arg = arg;
+    pool->next = 0;
+    pool->jobCount = jobCount;
+    pool->done = 0;
+    pthread_cond_broadcast(&pool->work);
+    take_pool_jobs(&pool->threads[0]);
+    while (pool->done < pool->jobCount) {
+        pthread_cond_wait(&pool->finished, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void free_thread_pool(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->closing = true;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->started; i++) {
+        pthread_join(pool->ids[i], NULL);
+    }
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->finished);
+    pthread_mutex_destroy(&pool->lock);
+    mem_free(MEM_AUTO_PLAYER, pool);
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void* worker(void* queue) {
+    JobQueue* jobs = queue;
+    for (;;) {
+        pthread_mutex_lock(&jobs->lock);
+        int index = jobs->next++;
+        pthread_mutex_unlock(&jobs->lock);
+        if (index >= jobs->jobCount) {
+            return NULL;
+        }
+        jobs->job(index, jobs->arg);
+    }
+}
+
+//
+static void take_pool_jobs(PoolThread* thread) {
+    ThreadPool* pool = thread->pool;
+    while (pool->next < pool->jobCount) {
+        int index = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->job(index, thread->id, pool->arg);
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->done == pool->jobCount) {
+            pthread_cond_signal(&pool->finished);
+        }
+    }
+}
+
+//
+static void* pool_worker(void* thread) {
+    ThreadPool* pool = ((PoolThread*)thread)->pool;
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->closing) {
+        take_pool_jobs(thread);
+        pthread_cond_wait(&pool->work, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
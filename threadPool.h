@@ -0,0 +1,68 @@
+/*
+ * threadPool.h
+ * Author: Michael Bossner
+ *
+ * Header file for threadPool.c
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#define MAX_THREADS 256
+
+typedef struct ThreadPool ThreadPool;
+
+/*
+ * Runs a number of independent jobs on a pool of threads. Each thread takes
+ * the next job that has not been started until there are none left. Returns
+ * once every job has finished.
+ *
+ * jobCount: How many jobs there are
+ *
+ * threads: How many threads to run the jobs on. Clamped to between 1 and
+ *         MAX_THREADS. With 1 thread the jobs are run on the calling thread.
+ *
+ * job: Function that runs a single job given its index and arg
+ *
+ * arg: Passed to every job
+ */
+void run_jobs(int jobCount, int threads, void (*job)(int index, void* arg),
+        void* arg);
+
+/*
+ * Starts threads that are kept to run jobs until the pool is freed. The
+ * threads sleep while there are no jobs.
+ *
+ * threads: How many threads run the jobs, counting the thread that runs
+ *         them. Clamped to between 1 and MAX_THREADS
+ *
+ * return: Returns the pool
+ */
+ThreadPool* create_thread_pool(int threads);
+
+/*
+ * Runs a number of independent jobs on the threads of a pool and the
+ * calling thread. Returns once every job has finished. Only one thread may
+ * run jobs on a pool at a time.
+ *
+ * pool: The pool
+ *
+ * jobCount: How many jobs there are
+ *
+ * job: Function that runs a single job given its index, the thread running
+ *         it and arg. The calling thread is thread 0 and the threads of the
+ *         pool are numbered from 1
+ *
+ * arg: Passed to every job
+ */
+void run_pool_jobs(ThreadPool* pool, int jobCount,
+        void (*job)(int index, int thread, void* arg), void* arg);
+
+/*
+ * Ends the threads of a pool and frees it.
+ *
+ * pool: A pool created by create_thread_pool
+ */
+void free_thread_pool(ThreadPool* pool);
+
+#endif
@@ -0,0 +1,309 @@
+/*
+ * tileFit.c
+ * Author: Michael Bossner
+ *
+ * This file contains functions for working out whether a tile can still be
+ * placed on the board using what is already known about related tiles.
+ */
+
+#include <stdlib.h>
+
+#include "tileFit.h"
+#include "game.h"
+#include "tilefile.h"
+#include "memStats.h"
+
+#define UNKNOWN_FIT -1
+#define FIT_LOG_START 64
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Checks whether a shape can be placed at a position on the board.
+ *
+ * state: The current state of the game
+ *
+ * shape: Index of the shape to be placed
+ *
+ * inst: Position to be checked. Rotation is a rotation of the shape
+ *
+ * return: Returns true if the shape can be placed at the position
+ */
+static bool is_shape_valid(GameStateInfo* state, int shape, int* inst);
+
+/*
+ * Logs what is known about a shape before it is changed, if changes are
+ * being logged.
+ *
+ * state: The current state of the game
+ *
+ * shape: Index of the shape about to be changed
+ */
+static void log_fit(GameStateInfo* state, int shape);
+
+/*
+ * Records what was found about a shape on the current move.
+ *
+ * state: The current state of the game
+ *
+ * shape: Index of the shape
+ *
+ * fits: Whether the shape can be placed
+ *
+ * witness: A valid placement of the shape or NULL if it does not fit
+ */
+static void record_fit(GameStateInfo* state, int shape, bool fits, 
+        int* witness);
+
+/*
+ * Tries to answer whether a shape fits using the shapes it is related to.
+ *
+ * state: The current state of the game
+ *
+ * shape: Index of the shape
+ *
+ * return: Returns 1 if the shape fits, 0 if it does not and -1 if nothing
+ *         related to the shape is known.
+ */
+static int infer_fit(GameStateInfo* state, int shape);
+
+/*
+ * Gets the scan position of a move. Positions are numbered in the order
+ * scan_fit checks them.
+ *
+ * state: The current state of the game
+ *
+ * inst: The move
+ *
+ * return: Returns the scan position
+ */
+static int scan_position(GameStateInfo* state, int* inst);
+
+/*
+ * Scans the board for a valid placement of a shape. Each rotation is only 
+ * scanned from its frontier onwards and the frontier is moved up to the 
+ * first valid placement found. The shape is marked dead when no rotation
+ * has a valid placement left.
+ *
+ * state: The current state of the game
+ *
+ * shape: Index of the shape
+ *
+ * return: Returns true if the shape can be placed on the board
+ */
+static bool scan_fit(GameStateInfo* state, int shape);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+void init_tile_fit(GameStateInfo* state) {
+    int count = state->tiles->shapeCount;
+    state->shapeFits = mem_malloc(MEM_BOARD, sizeof(ShapeFit) * count);
+    for (int i = 0; i < count; i++) {
+        state->shapeFits[i].checkedMove = NOT_CHECKED;
+        state->shapeFits[i].fits = false;
+        state->shapeFits[i].dead = false;
+        state->shapeFits[i].hasWitness = false;
+        for (int r = 0; r < ROTATIONS; r++) {
+            state->shapeFits[i].frontier[r] = 0;
+        }
+    }
+    state->fitLog = NULL;
+    state->fitLogCount = 0;
+    state->fitLogSize = 0;
+    state->logFits = false;
+}
+
+int mark_tile_fit(GameStateInfo* state) {
+    // games that never take a move back log nothing
+    state->logFits = true;
+    return state->fitLogCount;
+}
+
+void restore_tile_fit(GameStateInfo* state, int mark) {
+    // the newest change is undone first so each shape ends as at the mark
+    while (state->fitLogCount > mark) {
+        FitChange* change = &state->fitLog[--state->fitLogCount];
+        state->shapeFits[change->shape] = change->was;
+    }
+}
+
+void free_tile_fit(GameStateInfo* state) {
+    mem_free(MEM_BOARD, state->shapeFits);
+    state->shapeFits = NULL;
+    mem_free(MEM_BOARD, state->fitLog);
+    state->fitLog = NULL;
+}
+
+bool can_tile_fit(GameStateInfo* state) {
+    int shape = state->tiles->tileShape[state->tileIndex];
+    ShapeFit* fit = &state->shapeFits[shape];
+    if (fit->dead) {
+        return false;
+    } else if (fit->checkedMove == state->moveCount) {
+        return fit->fits;
+    }
+    // cells are never cleared so a placement that was valid before is
+    // still valid if none of its cells have been taken
+    if (fit->hasWitness && is_shape_valid(state, shape, fit->witness)) {
+        record_fit(state, shape, true, fit->witness);
+        return true;
+    }
+    int inferred = infer_fit(state, shape);
+    if (inferred != UNKNOWN_FIT) {
+        return inferred;
+    }
+    return scan_fit(state, shape);
+}
+
+bool is_move_ruled_out(GameStateInfo* state, int* inst) {
+    if (inst[COLM] >= MAX_MOVE_C || inst[ROW] >= MAX_MOVE_R) {
+        // never scanned
+        return false;
+    }
+    int shape = state->tiles->tileShape[state->tileIndex];
+    ShapeFit* fit = &state->shapeFits[shape];
+    if (fit->dead) {
+        return true;
+    }
+    // repeated rotations are only scanned once
+    int rotation = get_shape_rotation(state->tiles, state->tileIndex, 
+            inst[ROTATE]) % state->tiles->shapes[shape].distinct;
+    return scan_position(state, inst) < fit->frontier[rotation];
+}
+
+int count_placements(GameStateInfo* state) {
+    int shape = state->tiles->tileShape[state->tileIndex];
+    ShapeFit* fit = &state->shapeFits[shape];
+    if (fit->dead) {
+        return 0;
+    }
+    int rowCount = MAX_MOVE_R - MIN_MOVE;
+    int end = (MAX_MOVE_C - MIN_MOVE) * rowCount;
+    int count = 0;
+    int inst[INST_MAX];
+    for (inst[ROTATE] = 0; inst[ROTATE] < state->tiles->shapes[shape].distinct;
+            inst[ROTATE]++) {
+        // nothing before the frontier can be placed
+        for (int pos = fit->frontier[inst[ROTATE]]; pos < end; pos++) {
+            inst[COLM] = pos / rowCount + MIN_MOVE;
+            inst[ROW] = pos % rowCount + MIN_MOVE;
+            if (is_shape_valid(state, shape, inst)) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static bool is_shape_valid(GameStateInfo* state, int shape, int* inst) {
+    return is_move_valid(state->tiles->shapes[shape].rotations[inst[ROTATE]],
+            state, inst);
+}
+
+//
+static void log_fit(GameStateInfo* state, int shape) {
+    if (!state->logFits) {
+        return;
+    }
+    if (state->fitLogCount == state->fitLogSize) {
+        state->fitLogSize = state->fitLogSize == 0 ? FIT_LOG_START :
+                2 * state->fitLogSize;
+        state->fitLog = mem_realloc(MEM_BOARD, state->fitLog,
+                sizeof(FitChange) * state->fitLogSize);
+    }
+    FitChange* change = &state->fitLog[state->fitLogCount++];
+    change->shape = shape;
+    change->was = state->shapeFits[shape];
+}
+
+//
+static void record_fit(GameStateInfo* state, int shape, bool fits, 
+        int* witness) {
+    log_fit(state, shape);
+    ShapeFit* fit = &state->shapeFits[shape];
+    fit->checkedMove = state->moveCount;
+    fit->fits = fits;
+    if (witness != NULL) {
+        fit->hasWitness = true;
+        fit->witness[COLM] = witness[COLM];
+        fit->witness[ROW] = witness[ROW];
+        fit->witness[ROTATE] = witness[ROTATE];
+    }
+}
+
+//
+static int infer_fit(GameStateInfo* state, int shape) {
+    LoadedTilefile* tiles = state->tiles;
+    for (int other = 0; other < tiles->shapeCount; other++) {
+        ShapeFit* otherFit = &state->shapeFits[other];
+        // shape fits wherever a shape containing it fits
+        int cover = get_shape_cover(tiles, shape, other);
+        if (cover != NO_COVER && otherFit->hasWitness && 
+                ((otherFit->checkedMove == state->moveCount && 
+                otherFit->fits) || 
+                is_shape_valid(state, other, otherFit->witness))) {
+            int witness[INST_MAX];
+            witness[COLM] = otherFit->witness[COLM];
+            witness[ROW] = otherFit->witness[ROW];
+            witness[ROTATE] = (otherFit->witness[ROTATE] + cover) % ROTATIONS;
+            record_fit(state, shape, true, witness);
+            return VALID;
+        }
+        // shape cannot fit anywhere a shape inside it does not fit
+        cover = get_shape_cover(tiles, other, shape);
+        if (cover != NO_COVER && otherFit->dead) {
+            log_fit(state, shape);
+            state->shapeFits[shape].dead = true;
+            record_fit(state, shape, false, NULL);
+            return INVALID;
+        }
+    }
+    return UNKNOWN_FIT;
+}
+
+//
+static int scan_position(GameStateInfo* state, int* inst) {
+    return (inst[COLM] - MIN_MOVE) * (MAX_MOVE_R - MIN_MOVE) + 
+            (inst[ROW] - MIN_MOVE);
+}
+
+//
+static bool scan_fit(GameStateInfo* state, int shape) {
+    LoadedTilefile* tiles = state->tiles;
+    ShapeFit* fit = &state->shapeFits[shape];
+    int rowCount = MAX_MOVE_R - MIN_MOVE;
+    int end = (MAX_MOVE_C - MIN_MOVE) * rowCount;
+    int inst[INST_MAX];
+    log_fit(state, shape);
+    // rotations that repeat an earlier one do not need checking again
+    for (inst[ROTATE] = 0; inst[ROTATE] < tiles->shapes[shape].distinct; 
+            inst[ROTATE]++) {
+        // everything before the frontier is already known to be invalid
+        for (int pos = fit->frontier[inst[ROTATE]]; pos < end; pos++) {
+            inst[COLM] = pos / rowCount + MIN_MOVE;
+            inst[ROW] = pos % rowCount + MIN_MOVE;
+            if (is_shape_valid(state, shape, inst)) {
+                fit->frontier[inst[ROTATE]] = pos;
+                record_fit(state, shape, true, inst);
+                // every shape inside this one fits here as well
+                for (int other = 0; other < tiles->shapeCount; other++) {
+                    int cover = get_shape_cover(tiles, other, shape);
+                    if (cover != NO_COVER) {
+                        int witness[INST_MAX];
+                        witness[COLM] = inst[COLM];
+                        witness[ROW] = inst[ROW];
+                        witness[ROTATE] = (inst[ROTATE] + cover) % ROTATIONS;
+                        record_fit(state, other, true, witness);
+                    }
+                }
+                return true;
+            }
+        }
+        fit->frontier[inst[ROTATE]] = end;
+    }
+    fit->dead = true;
+    record_fit(state, shape, false, NULL);
+    return false;
+}
@@ -0,0 +1,117 @@
+/*
+ * tileFit.h
+ * Author: Michael Bossner
+ *
+ * Header file for tileFit.c
+ */
+
+#ifndef TILE_FIT_H
+#define TILE_FIT_H
+
+#include <stdbool.h>
+
+#include "game.h"
+#include "tilefile.h"
+
+#define NOT_CHECKED -1
+
+/*
+ * What is known about whether a shape can be placed on the board.
+ * Cells on the board are only ever filled, so once a placement is invalid it
+ * stays invalid for the rest of the game. unmake_move is the one exception
+ * and calls restore_tile_fit after emptying cells.
+ */
+struct ShapeFit {
+    int checkedMove; // Move the result was found on or NOT_CHECKED
+    bool fits; // Whether the shape could be placed on the checked move
+    bool dead; // The shape can never be placed again this game
+    bool hasWitness; // Whether a placement of the shape has been found
+    /* The last placement found for the shape. Rotation is of the shape */
+    int witness[INST_MAX];
+    /* Per rotation, every position scanned before this one is invalid */
+    int frontier[ROTATIONS];
+};
+
+/*
+ * What was known about a shape before it was changed
+ */
+struct FitChange {
+    int shape; // Index of the shape
+    ShapeFit was; // What was known before the change
+};
+
+/*
+ * Creates storage for what is known about each shape in the tilefile.
+ *
+ * state: The current state of the game
+ */
+void init_tile_fit(GameStateInfo* state);
+
+/*
+ * Frees the storage created by init_tile_fit.
+ *
+ * state: The current state of the game
+ */
+void free_tile_fit(GameStateInfo* state);
+
+/*
+ * Marks the point a move is made at so that what is found about shapes
+ * after it can be put back by restore_tile_fit. Every change to what is
+ * known about a shape is logged from the first call on.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns the mark
+ */
+int mark_tile_fit(GameStateInfo* state);
+
+/*
+ * Puts back what was known about each shape when a mark was made, undoing
+ * every change logged since. Marks must be restored in the opposite order
+ * to the one they were made in.
+ *
+ * state: The current state of the game
+ *
+ * mark: What mark_tile_fit returned
+ */
+void restore_tile_fit(GameStateInfo* state, int mark);
+
+/*
+ * Checks if the current tile can be placed anywhere on the board.
+ * Before scanning the board the check tries what is already known: the last
+ * placement found for the tile or any shape containing it, and shapes inside 
+ * it that are known not to fit this move. Whatever is found is recorded for
+ * later checks.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns true if the current tile can be placed on the board.
+ *         Returns false if there is no valid move for the current tile.
+ */
+bool can_tile_fit(GameStateInfo* state);
+
+/*
+ * Checks whether a move is already known to be invalid without looking at
+ * the board. A move is known to be invalid when an earlier scan for the 
+ * current tile has already passed over it.
+ *
+ * state: The current state of the game
+ *
+ * inst: The move to be checked. Rotation is the angle of the current tile
+ *
+ * return: Returns true if the move is known to be invalid.
+ *         Returns false if the move still needs to be checked.
+ */
+bool is_move_ruled_out(GameStateInfo* state, int* inst);
+
+/*
+ * Counts every valid placement of the current tile on the board. Rotations 
+ * that give the same cells as an earlier rotation are only counted once.
+ *
+ * state: The current state of the game
+ *
+ * return: Returns the number of valid placements
+ */
+int count_placements(GameStateInfo* state);
+
+#endif
@@ -11,6 +11,7 @@
 #include "game.h"
 #include "tilefile.h"
 #include "error.h"
+#include "memStats.h"
 
 #define MIN_TILES 1
 #define ROW_MAX 6
@@ -18,6 +19,12 @@
 
 #define TILE_END 1
 #define FILE_END 0
+#define TILE_INVALID 2
+#define TILE_CENTRE 2
+#define FORMATTED_LEN 121
+#define HASH_SPREAD 2654435761u
+#define EMPTY_SLOT -1
+#define MAX_COVER_SHAPES 1024
 
 
 ///////////////////////// Private Function Prototypes /////////////////////////
@@ -30,6 +37,7 @@
  * tilefile: The file to be read from
  *
  * return: Returns 1 if the tile has ended. Returns 0 if the file has ended. 
+ *         Returns 2 if the tile does not meet the definition of a tile.
  */
 static int add_tile(LoadedTilefile* loadedFile, FILE* tilefile);
 
@@ -43,24 +51,65 @@ static void free_tile(char** tile);
 /*
  * Checks a character in a tile for correctness.
  *
- * loadedFile: Information about the tilefile as well as a copy of all tiles
- *
- * tilefile: The file to be read from
- *
  * next: character in the tile to be checked
  *
  * row: row position of the character
  *
  * colm: column position of the character
  *
- * error_3: If the tile does not meet the definition of a tile.
+ * return: Returns false if the tile does not meet the definition of a tile.
  *         5x5 grid with either ('.' || '!') && ('\n' terminated)
  */
-static void file_check(LoadedTilefile* loadedFile, int next, int row, 
-        int colm);
+static bool file_check(int next, int row, int colm);
+
+/*
+ * Converts a tile into a bit mask of its '!' cells. Bit (row * 5 + column)
+ * is set when that cell of the tile is a '!'.
+ *
+ * tile: The tile to be converted
+ *
+ * return: Returns the bit mask of the tile
+ */
+static unsigned int tile_mask(char** tile);
+
+/*
+ * Rotates a tile bit mask 90 degrees clockwise the same way rotate_tile does.
+ *
+ * mask: The bit mask to be rotated
+ *
+ * return: Returns the rotated bit mask
+ */
+static unsigned int rotate_mask(unsigned int mask);
+
+/*
+ * Matches every loaded tile to a unique shape, creating the shape the first
+ * time it is seen. Tiles are matched using the smallest bit mask out of all
+ * of their rotations which is the same for any rotation of the tile.
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ */
+static void intern_tiles(LoadedTilefile* loadedFile);
+
+/*
+ * Works out which shapes fit inside other shapes under some rotation and
+ * stores the result in loadedFile. Skipped when there are too many shapes
+ * for the table to be worth its size.
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ */
+static void build_shape_cover(LoadedTilefile* loadedFile);
+
+/*
+ * Fills in the rotations and cell offsets of a new shape.
+ *
+ * shape: The shape to be filled in
+ *
+ * canonical: The rotation invariant bit mask of the shape
+ */
+static void init_shape(TileShape* shape, unsigned int canonical);
 
 /*
- * Prints a tile and all rotations of the tile space separated.
+ * Formats a tile and all rotations of the tile space separated.
  * tile   t90  t180  t270
  * !,,,, ,,,,! ,,,,, ,,,,,
  * ,,,,, ,,,,, ,,,,, ,,,,,
@@ -68,25 +117,13 @@ static void file_check(LoadedTilefile* loadedFile, int next, int row,
  * ,,,,, ,,,,, ,,,,, ,,,,,
  * ,,,,, ,,,,, ,,,,! !,,,,
  *
- * tile: tile to be printed
- *
- * tileRotated90: tile rotated 90 degrees to be printed
- *
- * tileRotated180: tile rotated 180 degrees to be printed
+ * shape: The shape of the tile
  *
- * tileRotated270: tile rotated 270 degrees to be printed
+ * offset: Rotation of the shape the tile is in
  *
- * return: Returns 0 when completed
- */
-static int print_tiles(char** tile, char** tileRotated90, 
-        char** tilerotated180, char** tileRotated270);
-
-/*
- * Creates storage for a tile to be copied too.
- * 
- * return: Returns the location of the tile storage
+ * return: Returns the formatted string
  */
-static char** alloc_tile(void);
+static char* format_tiles(TileShape* shape, int offset);
 
 //////////////////////////////// Functions ////////////////////////////////////
 
@@ -96,41 +133,82 @@ int load_tilefile(LoadedTilefile* loadedFile) {
         // file cannot be opened
         error_2();
     }
+    if (!read_tilefile(loadedFile, tilefile)) {
+        fclose(tilefile);
+        error_3();
+    }
+    fclose(tilefile);
+    return EXIT;
+}
 
+bool read_tilefile(LoadedTilefile* loadedFile, FILE* tilefile) {
     loadedFile->size = 0;
+    loadedFile->shapes = NULL;
+    loadedFile->shapeCount = 0;
+    loadedFile->tileShape = NULL;
+    loadedFile->tileRotation = NULL;
+    loadedFile->shapeCover = NULL;
     // Creates storage for a single tile
-    loadedFile->loadedTiles = malloc(sizeof(char**) * MIN_TILES);   
+    loadedFile->loadedTiles = mem_malloc(MEM_TILEFILE,
+            sizeof(char**) * MIN_TILES);
     loadedFile->loadedTiles[loadedFile->size] = alloc_tile();
     // Adds all tiles to the loadedFile storage and keeps count
-    while (add_tile(loadedFile, tilefile)) {
+    int result;
+    while ((result = add_tile(loadedFile, tilefile)) == TILE_END) {
         loadedFile->size++;
-        loadedFile->loadedTiles = realloc(loadedFile->loadedTiles, 
+        loadedFile->loadedTiles = mem_realloc(MEM_TILEFILE,
+                loadedFile->loadedTiles,
                 sizeof(char**) * (loadedFile->size + 1));
         loadedFile->loadedTiles[loadedFile->size] = alloc_tile();
     }
+    if (result == TILE_INVALID) {
+        free_loaded_tiles(loadedFile);
+        return false;
+    }
+    index_tiles(loadedFile);
+    return true;
+}
 
-    fclose(tilefile);
-    return EXIT;
+void index_tiles(LoadedTilefile* loadedFile) {
+    loadedFile->shapeCount = 0;
+    loadedFile->shapeCover = NULL;
+    intern_tiles(loadedFile);
+    build_shape_cover(loadedFile);
+}
+
+char** alloc_tile(void) {
+    char** tile = mem_malloc(MEM_TILEFILE, sizeof(char*) * COLOMN_MAX);
+    for (int i = 0; i < COLOMN_MAX; i++) {
+        tile[i] = mem_malloc(MEM_TILEFILE, sizeof(char) * ROW_MAX);
+    }
+    return tile;
+}
+
+void write_tilefile(LoadedTilefile* loadedFile, FILE* file) {
+    for (int i = 0; i <= loadedFile->size; i++) {
+        // tiles are separated by an empty line
+        if (i > 0) {
+            fprintf(file, "\n");
+        }
+        for (int colm = 0; colm < COLOMN_MAX; colm++) {
+            fprintf(file, "%s\n", loadedFile->loadedTiles[i][colm]);
+        }
+    }
 }
 
 int display_tilefile(LoadedTilefile* loadedFile) {
     // goes through ever tile loaded into loadedFile.
     for (int i = 0; i <= loadedFile->size; i++) {
-        // rotates the current tile to all angles then prints the tiles
-        char** tileRotated90 = rotate_tile(loadedFile->loadedTiles[i],
-                ROTATE_90, CALL);
-        char** tileRotated180 = rotate_tile(loadedFile->loadedTiles[i],
-                ROTATE_180, CALL);
-        char** tileRotated270 = rotate_tile(loadedFile->loadedTiles[i],
-                ROTATE_270, CALL);
-        print_tiles(loadedFile->loadedTiles[i], tileRotated90, tileRotated180,
-                tileRotated270);
+        // tiles with the same shape and rotation share the same output
+        TileShape* shape = &loadedFile->shapes[loadedFile->tileShape[i]];
+        int offset = loadedFile->tileRotation[i];
+        if (shape->formatted[offset] == NULL) {
+            shape->formatted[offset] = format_tiles(shape, offset);
+        }
+        fputs(shape->formatted[offset], stdout);
         if (i < loadedFile->size) {
             printf("\n");
         }       
-        free_tile(tileRotated90);
-        free_tile(tileRotated180);
-        free_tile(tileRotated270);
     }
     return EXIT;
 }
@@ -166,22 +244,57 @@ char** rotate_tile(char** tile, int angle, int call) {
     }
 }
 
+char** get_rotated_tile(LoadedTilefile* loadedFile, int index, int angle) {
+    TileShape* shape = &loadedFile->shapes[loadedFile->tileShape[index]];
+    return shape->rotations[get_shape_rotation(loadedFile, index, angle)];
+}
+
+int get_shape_cover(LoadedTilefile* loadedFile, int a, int b) {
+    if (loadedFile->shapeCover == NULL) {
+        return NO_COVER;
+    }
+    return loadedFile->shapeCover[a * loadedFile->shapeCount + b];
+}
+
+TileShape* get_tile_shape(LoadedTilefile* loadedFile, int index) {
+    return &loadedFile->shapes[loadedFile->tileShape[index]];
+}
+
+int get_shape_rotation(LoadedTilefile* loadedFile, int index, int angle) {
+    return (loadedFile->tileRotation[index] + angle / ROTATE_90) % ROTATIONS;
+}
+
 int free_loaded_tiles(LoadedTilefile* loadedFile) {
+    // frees every shape and its rotations
+    for (int i = 0; i < loadedFile->shapeCount; i++) {
+        for (int r = 0; r < ROTATIONS; r++) {
+            free_tile(loadedFile->shapes[i].rotations[r]);
+            mem_free(MEM_TILEFILE, loadedFile->shapes[i].formatted[r]);
+        }
+    }
+    mem_free(MEM_TILEFILE, loadedFile->shapes);
+    mem_free(MEM_TILEFILE, loadedFile->tileShape);
+    mem_free(MEM_TILEFILE, loadedFile->tileRotation);
+    mem_free(MEM_TILEFILE, loadedFile->shapeCover);
+    loadedFile->shapeCover = NULL;
+    loadedFile->shapes = NULL;
+    loadedFile->shapeCount = 0;
     // frees memory in a 3D array
     for (; loadedFile->size >= 0; loadedFile->size--) {
         
         for (int i = 0; i < COLOMN_MAX; i++) {
-            free(loadedFile->loadedTiles[loadedFile->size][i]);
+            mem_free(MEM_TILEFILE,
+                    loadedFile->loadedTiles[loadedFile->size][i]);
         }
-        free(loadedFile->loadedTiles[loadedFile->size]);
+        mem_free(MEM_TILEFILE, loadedFile->loadedTiles[loadedFile->size]);
     }
-    free(loadedFile->loadedTiles);
+    mem_free(MEM_TILEFILE, loadedFile->loadedTiles);
     return EXIT;
 }
 
-void print_tile(LoadedTilefile* loadedFile) {
+void print_tile(LoadedTilefile* loadedFile, int index) {
     for (int colm = 0; colm < COLOMN_MAX; colm++) {
-        printf("%s\n", loadedFile->loadedTiles[loadedFile->index][colm]);
+        printf("%s\n", loadedFile->loadedTiles[index][colm]);
     }
 }
 
@@ -194,8 +307,9 @@ static int add_tile(LoadedTilefile* loadedFile, FILE* tilefile) {
     // Adds the tile to state unless the file is invalid
     FOREVER {
         next = fgetc(tilefile);
-        file_check(loadedFile, next, row, colomn);
-        if (next == EOF) {
+        if (!file_check(next, row, colomn)) {
+            return TILE_INVALID;
+        } else if (next == EOF) {
             return FILE_END;
         } else if (colomn >= COLOMN_MAX) {
             return TILE_END;
@@ -214,46 +328,175 @@ static int add_tile(LoadedTilefile* loadedFile, FILE* tilefile) {
 //
 static void free_tile(char** tile) {
     for (int i = 0; i < COLOMN_MAX; i++) {
-        free(tile[i]);
+        mem_free(MEM_TILEFILE, tile[i]);
     }
-    free(tile);
+    mem_free(MEM_TILEFILE, tile);
 }
 
 //
-static void file_check(LoadedTilefile* loadedFile, int next, int row, 
-        int colm) {
+static bool file_check(int next, int row, int colm) {
     if (row == (ROW_MAX - 1) && next != '\n') {
         // tile line is not the correct size
-        free_loaded_tiles(loadedFile);
-        error_3();
+        return false;
     } else if ((row < (ROW_MAX - 1) && colm < COLOMN_MAX) && 
             (next != ',' && next != '!')) {
         // Tile does not contain the correct format
-        free_loaded_tiles(loadedFile);
-        error_3();
+        return false;
     } else if (colm >= COLOMN_MAX && (next != EOF && next != '\n')) {
         // tile height is not the correct size
-        free_loaded_tiles(loadedFile);
-        error_3();
+        return false;
     }
+    return true;
 }
 
 //
-static int print_tiles(char** tile, char** tileRotated90, 
-        char** tilerotated180, char** tileRotated270) {
-    // prints every line of the tiles
-    for (int i = 0; i < COLOMN_MAX; i++) {
-        printf("%s %s %s %s\n", tile[i], tileRotated90[i], 
-                tilerotated180[i], tileRotated270[i]);
+static unsigned int tile_mask(char** tile) {
+    unsigned int mask = 0;
+    for (int colm = 0; colm < TILE_DIM; colm++) {
+        for (int row = 0; row < TILE_DIM; row++) {
+            if (tile[colm][row] == '!') {
+                mask |= 1u << (colm * TILE_DIM + row);
+            }
+        }
     }
-    return EXIT;
+    return mask;
+}
+
+//
+static unsigned int rotate_mask(unsigned int mask) {
+    unsigned int rotated = 0;
+    // cell (colm, row) moves to (row, 4 - colm) when rotated clockwise
+    for (int colm = 0; colm < TILE_DIM; colm++) {
+        for (int row = 0; row < TILE_DIM; row++) {
+            if (mask & (1u << (colm * TILE_DIM + row))) {
+                rotated |= 1u << (row * TILE_DIM + (TILE_DIM - 1 - colm));
+            }
+        }
+    }
+    return rotated;
+}
+
+//
+static void intern_tiles(LoadedTilefile* loadedFile) {
+    int tileCount = loadedFile->size + 1;
+    loadedFile->tileShape = mem_malloc(MEM_TILEFILE, sizeof(int) * tileCount);
+    loadedFile->tileRotation = mem_malloc(MEM_TILEFILE,
+            sizeof(int) * tileCount);
+    loadedFile->shapes = mem_malloc(MEM_TILEFILE,
+            sizeof(TileShape) * tileCount);
+    // hash table of shape indexes keyed by the canonical mask
+    int tableSize = 1;
+    while (tableSize < tileCount * 2) {
+        tableSize *= 2;
+    }
+    int* table = mem_malloc(MEM_TILEFILE, sizeof(int) * tableSize);
+    for (int i = 0; i < tableSize; i++) {
+        table[i] = EMPTY_SLOT;
+    }
+
+    for (int i = 0; i < tileCount; i++) {
+        // the smallest mask of all rotations is the canonical form
+        unsigned int mask = tile_mask(loadedFile->loadedTiles[i]);
+        unsigned int canonical = mask;
+        int turns = 0;
+        for (int r = 1; r < ROTATIONS; r++) {
+            mask = rotate_mask(mask);
+            if (mask < canonical) {
+                canonical = mask;
+                turns = r;
+            }
+        }
+        // find the shape or add it if it has not been seen yet
+        unsigned int slot = (canonical * HASH_SPREAD) & (tableSize - 1);
+        while (table[slot] != EMPTY_SLOT && 
+                loadedFile->shapes[table[slot]].canonical != canonical) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (table[slot] == EMPTY_SLOT) {
+            table[slot] = loadedFile->shapeCount;
+            init_shape(&loadedFile->shapes[loadedFile->shapeCount], 
+                    canonical);
+            loadedFile->shapeCount++;
+        }
+        // turning the tile by turns gives the canonical form so turning the
+        // canonical form the rest of the way around gives the tile
+        loadedFile->tileShape[i] = table[slot];
+        loadedFile->tileRotation[i] = (ROTATIONS - turns) % ROTATIONS;
+    }
+    mem_free(MEM_TILEFILE, table);
+    // only keep storage for the shapes that were found
+    loadedFile->shapes = mem_realloc(MEM_TILEFILE, loadedFile->shapes, 
+            sizeof(TileShape) * loadedFile->shapeCount);
 }
 
 //
-static char** alloc_tile(void) {
-    char** tile = malloc(sizeof(char*) * COLOMN_MAX);
+static void build_shape_cover(LoadedTilefile* loadedFile) {
+    int count = loadedFile->shapeCount;
+    if (count > MAX_COVER_SHAPES) {
+        return;
+    }
+    loadedFile->shapeCover = mem_malloc(MEM_TILEFILE,
+            sizeof(int) * count * count);
+    for (int a = 0; a < count; a++) {
+        TileShape* small = &loadedFile->shapes[a];
+        for (int b = 0; b < count; b++) {
+            unsigned int large = loadedFile->shapes[b].masks[0];
+            int cover = NO_COVER;
+            // a shape is not related to itself
+            for (int r = 0; a != b && r < small->distinct; r++) {
+                if ((small->masks[r] & large) == small->masks[r]) {
+                    cover = r;
+                    break;
+                }
+            }
+            loadedFile->shapeCover[a * count + b] = cover;
+        }
+    }
+}
+
+//
+static void init_shape(TileShape* shape, unsigned int canonical) {
+    shape->canonical = canonical;
+    shape->cellCount = 0;
+    shape->distinct = ROTATIONS;
+    unsigned int mask = canonical;
+    for (int r = 0; r < ROTATIONS; r++) {
+        shape->masks[r] = mask;
+        shape->formatted[r] = NULL;
+        if (r > 0 && mask == canonical && shape->distinct == ROTATIONS) {
+            shape->distinct = r;
+        }
+        // build the tile and list its cells in the order they are checked
+        shape->rotations[r] = alloc_tile();
+        int cell = 0;
+        for (int colm = 0; colm < TILE_DIM; colm++) {
+            for (int row = 0; row < TILE_DIM; row++) {
+                if (mask & (1u << (colm * TILE_DIM + row))) {
+                    shape->rotations[r][colm][row] = '!';
+                    shape->cellY[r][cell] = colm - TILE_CENTRE;
+                    shape->cellX[r][cell] = row - TILE_CENTRE;
+                    cell++;
+                } else {
+                    shape->rotations[r][colm][row] = ',';
+                }
+            }
+            shape->rotations[r][colm][TILE_DIM] = '\0';
+        }
+        shape->cellCount = cell;
+        mask = rotate_mask(mask);
+    }
+}
+
+//
+static char* format_tiles(TileShape* shape, int offset) {
+    char* formatted = mem_malloc(MEM_TILEFILE, sizeof(char) * FORMATTED_LEN);
+    int len = 0;
     for (int i = 0; i < COLOMN_MAX; i++) {
-        tile[i] = malloc(sizeof(char) * ROW_MAX);
+        len += sprintf(&formatted[len], "%s %s %s %s\n", 
+                shape->rotations[offset][i],
+                shape->rotations[(offset + 1) % ROTATIONS][i],
+                shape->rotations[(offset + 2) % ROTATIONS][i],
+                shape->rotations[(offset + 3) % ROTATIONS][i]);
     }
-    return tile;
+    return formatted;
 }
\ No newline at end of file
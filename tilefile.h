@@ -8,13 +8,37 @@
 #ifndef TILEFILE_H
 #define TILEFILE_H
 
+#include <stdio.h>
+#include <stdbool.h>
+
 #define CALL 0
 #define ROTATE_90 90
 #define ROTATE_180 180
 #define ROTATE_270 270
+#define ROTATIONS 4
+#define TILE_DIM 5
+#define TILE_CELLS 25
+#define NO_COVER -1
 
+typedef struct TileShape TileShape;
 typedef struct LoadedTilefile LoadedTilefile;
 
+/*
+ * A unique tile shape. Every tile in the tilefile that is identical to 
+ * another up to rotation shares the same shape, so anything worked out for
+ * a shape is worked out once for all of those tiles.
+ */
+struct TileShape {
+    unsigned int canonical; // Rotation invariant form of the shape
+    unsigned int masks[ROTATIONS]; // '!' cells of each rotation as bits
+    char** rotations[ROTATIONS]; // The shape rotated 0, 90, 180 and 270
+    char* formatted[ROTATIONS]; // display_tilefile output for each offset
+    int distinct; // How many of the rotations are different (1, 2 or 4)
+    int cellCount; // Number of '!' cells in the shape
+    /* Offset of each '!' cell from the centre of the tile per rotation */
+    int cellY[ROTATIONS][TILE_CELLS], cellX[ROTATIONS][TILE_CELLS];
+};
+
 /*
  * Contains all tiles loaded from a tilefile as well as information about the
  * tilefile such as how many tile there are and the name of the file.
@@ -24,12 +48,22 @@ struct LoadedTilefile {
     char*** loadedTiles; // All tiles copied into memory ready for use in game
     char** tileRotated; // Storage for a tile that has been rotated
     int size; // How many tiles are stored in the tilefile
-    int index; // Current tile selected for use
-
+    TileShape* shapes; // Every unique shape found in the tilefile
+    int shapeCount; // How many unique shapes there are
+    int* tileShape; // The shape each tile is made from
+    int* tileRotation; // Rotation of the shape that gives each tile
+    /* 
+     * Subset relation between shapes. shapeCover[a * shapeCount + b] is the
+     * rotation of shape a whose cells all lie inside rotation 0 of shape b 
+     * or NO_COVER if there is none. NULL when there are too many shapes.
+     */
+    int* shapeCover;
 };
 
 /*
  * Copies all tiles from the tilefile into memory ready for use in the game.
+ * Each tile is then matched to its unique shape so that tiles which are
+ * identical up to rotation share the same rotations and precomputations.
  *
  * loadedFile: Information about the tilefile as well as a copy of all tiles
  *
@@ -42,6 +76,45 @@ struct LoadedTilefile {
  */
 int load_tilefile(LoadedTilefile* loadedFile);
 
+/*
+ * Reads every tile from an open tilefile into memory the same way 
+ * load_tilefile does but reports invalid contents instead of ending the 
+ * game. Nothing is left allocated when the contents are invalid.
+ *
+ * loadedFile: Where the tiles are stored
+ *
+ * tilefile: The open tilefile to be read
+ *
+ * return: Returns true if the tiles were loaded. Returns false if the tile 
+ *         does not meet the definition of a tile.
+ */
+bool read_tilefile(LoadedTilefile* loadedFile, FILE* tilefile);
+
+/*
+ * Matches every loaded tile to its unique shape and works out how the shapes
+ * relate to each other. Must be called once all tiles are stored in
+ * loadedFile when the tiles did not come from load_tilefile.
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ */
+void index_tiles(LoadedTilefile* loadedFile);
+
+/*
+ * Writes all loaded tiles to a file in the tilefile format.
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ *
+ * file: The file to be written too
+ */
+void write_tilefile(LoadedTilefile* loadedFile, FILE* file);
+
+/*
+ * Creates storage for a tile to be copied too.
+ * 
+ * return: Returns the location of the tile storage
+ */
+char** alloc_tile(void);
+
 /*
  * Prints all tiles loaded from the tilefile and there rotations to the console
  * Rotations will be space separated from the original tile
@@ -66,6 +139,62 @@ int display_tilefile(LoadedTilefile* loadedFile);
  */
 char** rotate_tile(char** tile, int angle, int call);
 
+/*
+ * Gets the rotation of shape a whose cells all lie within a rotation of
+ * shape b. Because a tile only needs its '!' cells to be free, shape a can be
+ * placed anywhere shape b can be when a is rotated rotB + the returned value.
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ *
+ * a: Index of the smaller shape
+ *
+ * b: Index of the larger shape
+ *
+ * return: Returns the rotation offset of shape a or NO_COVER if no rotation
+ *         of shape a lies inside shape b.
+ */
+int get_shape_cover(LoadedTilefile* loadedFile, int a, int b);
+
+/*
+ * Gets a tile rotated to the specified angle. Unlike rotate_tile no memory
+ * is allocated as the rotations are shared from the tiles shape.
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ *
+ * index: Index of the tile to be rotated
+ *
+ * angle: Angle the tile is to be rotated too. Must be in 90 degree increments
+ *         starting at 0
+ *
+ * return: Returns the rotated tile. Must not be freed.
+ */
+char** get_rotated_tile(LoadedTilefile* loadedFile, int index, int angle);
+
+/*
+ * Gets the shape a tile is made from.
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ *
+ * index: Index of the tile
+ *
+ * return: Returns the shape of the tile
+ */
+TileShape* get_tile_shape(LoadedTilefile* loadedFile, int index);
+
+/*
+ * Gets which of a shapes rotations a tile is in when rotated to an angle.
+ *
+ * loadedFile: Information about the tilefile as well as a copy of all tiles
+ *
+ * index: Index of the tile
+ *
+ * angle: Angle the tile is rotated too. Must be in 90 degree increments
+ *         starting at 0
+ *
+ * return: Returns the rotation of the tiles shape between 0 and 3
+ */
+int get_shape_rotation(LoadedTilefile* loadedFile, int index, int angle);
+
 /*
  * Frees the memory holding all tiles loaded from the tilefile
  *
@@ -79,7 +208,9 @@ int free_loaded_tiles(LoadedTilefile* loadedFile);
  * Prints the current tile that is ready to be used for play to the console
  *
  * loadedFile: Information about the tilefile as well as a copy of all tiles
+ *
+ * index: Index of the tile to be printed
  */
-void print_tile(LoadedTilefile* loadedFile);
+void print_tile(LoadedTilefile* loadedFile, int index);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,174 @@
+/*
+ * trace.c
+ * Author: Michael Bossner
+ *
+ * This file contains the timeline written by --trace. Every span of a turn
+ * is added to a list in memory as a begin and an end event and the whole
+ * list is written once when the program exits, so tracing a game costs a
+ * clock read and a locked append per event. The file can be opened by
+ * chrome://tracing or Perfetto.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "trace.h"
+#include "game.h"
+
+#define EVENT_START 1024
+#define SECOND_NS 1000000000LL
+#define MICROSECOND_NS 1e3
+#define BEGIN 'B'
+#define END 'E'
+
+typedef struct TraceEvent TraceEvent;
+
+/*
+ * One begin or end of a span
+ */
+struct TraceEvent {
+    const char* name; // Name of the span
+    char phase; // BEGIN or END
+    int64_t ns; // When it happened
+    int thread; // Index of the thread it happened on
+    int turn; // Moves made in the game so far. Only kept for a begin
+    char player; // Player to move. Only kept for a begin
+    int tileIndex; // Tile the player to move places. Only kept for a begin
+};
+
+// The file the trace is written to. NULL while the trace is off
+static FILE* traceFile = NULL;
+// Protects events, eventCount, eventSize and threadCount
+static pthread_mutex_t traceLock = PTHREAD_MUTEX_INITIALIZER;
+// Events in the order they were added
+static TraceEvent* events = NULL;
+// Number of events added
+static int eventCount = 0;
+// Number of events there is room for
+static int eventSize = 0;
+// Threads given an index so far
+static int threadCount = 0;
+// Index of the calling thread plus 1. Unset on threads with no events
+static pthread_key_t threadKey;
+
+///////////////////////// Private Function Prototypes /////////////////////////
+
+/*
+ * Adds an event to the list.
+ *
+ * name: Name of the span
+ *
+ * phase: BEGIN or END
+ *
+ * state: The game the span belongs to. NULL for an end, which takes what
+ *         its begin has
+ */
+static void add_event(const char* name, char phase, GameStateInfo* state);
+
+/*
+ * Writes every event to the trace file and frees them. Registered with
+ * atexit.
+ */
+static void write_trace(void);
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+bool enable_trace(char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    if (traceFile != NULL) {
+        // the last --trace given is the one written
+        fclose(traceFile);
+    } else {
+        pthread_key_create(&threadKey, NULL);
+        atexit(write_trace);
+    }
+    traceFile = file;
+    return true;
+}
+
+void trace_begin(const char* name, GameStateInfo* state) {
+    if (traceFile != NULL) {
+        add_event(name, BEGIN, state);
+    }
+}
+
+void trace_end(const char* name) {
+    if (traceFile != NULL) {
+        add_event(name, END, NULL);
+    }
+}
+
+////////////////////////////// Private Functions //////////////////////////////
+//
+static void add_event(const char* name, char phase, GameStateInfo* state) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    TraceEvent event;
+    event.name = name;
+    event.phase = phase;
+    event.ns = now.tv_sec * SECOND_NS + now.tv_nsec;
+    if (state != NULL) {
+        event.turn = state->moveCount;
+        event.player = state->turn == P1 ? PLAYER_1 : PLAYER_2;
+        event.tileIndex = state->tileIndex;
+    }
+    intptr_t thread = (intptr_t)pthread_getspecific(threadKey);
+    pthread_mutex_lock(&traceLock);
+    if (thread == 0) {
+        thread = ++threadCount;
+        pthread_setspecific(threadKey, (void*)thread);
+    }
+    event.thread = thread - 1;
+    if (eventCount == eventSize) {
+        eventSize = eventSize == 0 ? EVENT_START : eventSize * 2;
+        events = realloc(events, sizeof(TraceEvent) * eventSize);
+    }
+    events[eventCount++] = event;
+    pthread_mutex_unlock(&traceLock);
+}
+
+//
+static void write_trace(void) {
+    pid_t pid = getpid();
+    pthread_mutex_lock(&traceLock);
+    // times start at the first event so they stay small
+    int64_t first = eventCount > 0 ? events[0].ns : 0;
+    for (int i = 1; i < eventCount; i++) {
+        if (events[i].ns < first) {
+            first = events[i].ns;
+        }
+    }
+    fprintf(traceFile, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    for (int i = 0; i < eventCount; i++) {
+        TraceEvent* event = &events[i];
+        fprintf(traceFile, "%s\n  {\"name\": \"%s\", \"ph\": \"%c\", "
+                "\"ts\": %.3f, \"pid\": %d, \"tid\": %d", i == 0 ? "" : ",",
+                event->name, event->phase,
+                (event->ns - first) / MICROSECOND_NS, (int)pid,
+                event->thread);
+        if (event->phase == BEGIN) {
+            fprintf(traceFile, ", \"args\": {\"turn\": %d, \"player\": "
+                    "\"%c\", \"tile\": %d}", event->turn, event->player,
+                    event->tileIndex);
+        }
+        fputc('}', traceFile);
+    }
+    fprintf(traceFile, "\n]}\n");
+    fclose(traceFile);
+    traceFile = NULL;
+    free(events);
+    events = NULL;
+    eventCount = 0;
+    eventSize = 0;
+    pthread_mutex_unlock(&traceLock);
+}
\ No newline at end of file
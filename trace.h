@@ -0,0 +1,51 @@
+/*
+ * trace.h
+ * Author: Michael Bossner
+ *
+ * Header file for trace.c
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+
+#include "game.h"
+
+#define TRACE_TURN "turn"
+#define TRACE_GAME_OVER "game_over"
+#define TRACE_MOVE "move"
+#define TRACE_UPDATE "update_board"
+#define TRACE_RENDER "render"
+#define TRACE_SAVE "save"
+
+/*
+ * Turns on the trace for the rest of the program. Events are kept in memory
+ * and written to the file as Chrome trace events when the program exits.
+ *
+ * path: Name of the file the trace is written to. Created straight away so
+ *         that a bad name is found before any game is played
+ *
+ * return: Returns false if the file can't be created
+ */
+bool enable_trace(char* path);
+
+/*
+ * Starts a span of the trace. Does nothing while the trace is off. Safe to
+ * call from any thread.
+ *
+ * name: Name of the span. One of the TRACE_ defines
+ *
+ * state: The game the span belongs to. Its turn, player and tile are kept
+ */
+void trace_begin(const char* name, GameStateInfo* state);
+
+/*
+ * Ends the last span started by the thread. Does nothing while the trace is
+ * off. Safe to call from any thread.
+ *
+ * name: Name of the span. The same as was given to trace_begin
+ */
+void trace_end(const char* name);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,74 @@
+/*
+ * transTable.c
+ * Author: Michael Bossner
+ *
+ * This file contains the transposition table shared by searches. Each slot
+ * is two words: the entry packed into one and the key exclusive or'd with
+ * the entry in the other. A reader that sees halves from two different
+ * writes gets a key that does not match and treats the slot as empty.
+ */
+
+#include <stdlib.h>
+
+#include "transTable.h"
+#include "memStats.h"
+
+#define SLOT_WORDS 2
+#define CHECK_WORD 0
+#define DATA_WORD 1
+#define SCORE_MASK 0xFFFFFFFFULL
+#define MOVE_SHIFT 32
+#define MOVE_MASK 0xFFFFFFULL
+#define DEPTH_SHIFT 56
+#define DEPTH_MASK 0x3FULL
+#define BOUND_SHIFT 62
+#define BOUND_MASK 0x3ULL
+
+/*
+ * A table of searched positions
+ */
+struct TransTable {
+    uint64_t* slots; // SLOT_WORDS words per entry
+    uint64_t mask; // Number of entries less 1
+};
+
+//////////////////////////////// Functions ////////////////////////////////////
+
+TransTable* create_trans_table(int bits) {
+    TransTable* table = mem_malloc(MEM_AUTO_PLAYER, sizeof(TransTable));
+    table->mask = (1ULL << bits) - 1;
+    table->slots = mem_calloc(MEM_AUTO_PLAYER,
+            (table->mask + 1) * SLOT_WORDS, sizeof(uint64_t));
+    return table;
+}
+
+void free_trans_table(TransTable* table) {
+    mem_free(MEM_AUTO_PLAYER, table->slots);
+    mem_free(MEM_AUTO_PLAYER, table);
+}
+
+bool probe_table(TransTable* table, uint64_t key, TableEntry* entry) {
+    uint64_t* slot = &table->slots[(key & table->mask) * SLOT_WORDS];
+    uint64_t data = __atomic_load_n(&slot[DATA_WORD], __ATOMIC_RELAXED);
+    uint64_t check = __atomic_load_n(&slot[CHECK_WORD], __ATOMIC_RELAXED);
+    // an empty slot has no data and a check of 0
+    if ((check ^ data) != key || data == 0) {
+        return false;
+    }
+    entry->score = (int32_t)(uint32_t)(data & SCORE_MASK);
+    // moves are stored one higher so that NO_MOVE fits
+    entry->move = (int)((data >> MOVE_SHIFT) & MOVE_MASK) - 1;
+    entry->depth = (int)((data >> DEPTH_SHIFT) & DEPTH_MASK);
+    entry->bound = (int)((data >> BOUND_SHIFT) & BOUND_MASK);
+    return true;
+}
+
+void store_table(TransTable* table, uint64_t key, TableEntry* entry) {
+    uint64_t* slot = &table->slots[(key & table->mask) * SLOT_WORDS];
+    uint64_t data = ((uint64_t)(uint32_t)entry->score & SCORE_MASK) |
+            (((uint64_t)(entry->move + 1) & MOVE_MASK) << MOVE_SHIFT) |
+            (((uint64_t)entry->depth & DEPTH_MASK) << DEPTH_SHIFT) |
+            (((uint64_t)entry->bound & BOUND_MASK) << BOUND_SHIFT);
+    __atomic_store_n(&slot[DATA_WORD], data, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot[CHECK_WORD], key ^ data, __ATOMIC_RELAXED);
+}
\ No newline at end of file
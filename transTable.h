@@ -0,0 +1,74 @@
+/*
+ * transTable.h
+ * Author: Michael Bossner
+ *
+ * Header file for transTable.c
+ */
+
+#ifndef TRANS_TABLE_H
+#define TRANS_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BOUND_EXACT 0
+#define BOUND_LOWER 1
+#define BOUND_UPPER 2
+
+typedef struct TableEntry TableEntry;
+typedef struct TransTable TransTable;
+
+/*
+ * What is known about a position that has already been searched
+ */
+struct TableEntry {
+    int score; // Score of the position for the player to move
+    int move; // Best move found or NO_MOVE
+    int depth; // How deep the position was searched
+    int bound; // Whether score is exact or a lower or upper bound
+};
+
+/*
+ * Creates a transposition table. The table can be read and written by many
+ * threads at once without locks. An entry torn by two threads writing at
+ * once is never returned.
+ *
+ * bits: The table holds 2 to the power of bits entries
+ *
+ * return: Returns the new table
+ */
+TransTable* create_trans_table(int bits);
+
+/*
+ * Frees a table created by create_trans_table.
+ *
+ * table: The table to be freed
+ */
+void free_trans_table(TransTable* table);
+
+/*
+ * Looks up a position in a table.
+ *
+ * table: The table
+ *
+ * key: Zobrist key of the position
+ *
+ * entry: Where what is known about the position is returned
+ *
+ * return: Returns true if the position was found
+ */
+bool probe_table(TransTable* table, uint64_t key, TableEntry* entry);
+
+/*
+ * Stores what is known about a position in a table, replacing whatever was
+ * stored in its place.
+ *
+ * table: The table
+ *
+ * key: Zobrist key of the position
+ *
+ * entry: What is known about the position
+ */
+void store_table(TransTable* table, uint64_t key, TableEntry* entry);
+
+#endif
\ No newline at end of file